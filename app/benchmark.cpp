@@ -0,0 +1,502 @@
+/**
+ * @file benchmark.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Benchmarks for the perception pipeline.
+ * @details Usage: perception-bench <mode> [iterations]
+ *          - tiling: single downscaled pass vs. tiled native-resolution pass
+ *            on a 4K canvas holding shrunken copies of bus.jpg. Reports
+ *            frames per second and small-person recall for both.
+ *          - decode: person-only PersonDetector decode loop vs. the runtime
+ *            configured GenericDetector on synthetic YOLOv3 output tensors.
+ *            Needs no model weights.
+ *          - synthetic: full Tracker pipeline (decode, NMS, tracking,
+ *            localization, overlay) driven by a SyntheticEngine for growing
+ *            crowd sizes. Reports frames per second. Needs no model weights.
+ *          - association: detection-to-track association of
+ *            Tracker::updateTrackers, nested loop vs. spatial grid, on
+ *            synthetic crowds of 10 to 500 people. Reports microseconds per
+ *            frame and per person. Needs no model weights.
+ *          - layers: per-layer profile of the YOLOv3 forward pass on
+ *            bus.jpg, grouped by layer type, with FLOPs and memory at the
+ *            detector's input shape. Prints the slowest layers and writes
+ *            the full profile to layer_profile.json.
+ *          - tracking: tracker updates of a synthetic crowd of 20 people on
+ *            720p frames, on the full colour frame vs. the shared
+ *            downscaled and grayscale FrameCache images. Reports
+ *            microseconds per track update. Needs no model weights.
+ * @version 0.1
+ * @date 2024-11-04
+ */
+
+// C++ system headers (alphabetical order)
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Third-party library headers
+#include <opencv2/opencv.hpp>
+
+// Other/local headers (alphabetical order)
+#include "Detector.hpp"
+#include "InferenceEngine.hpp"
+#include "LayerProfiler.hpp"
+#include "SpatialGrid.hpp"
+#include "TiledDetection.hpp"
+#include "Tracker.hpp"
+#include "detectHuman.hpp"
+
+namespace {
+
+/// Project root, used to locate the YOLO files
+const std::string kProjectRoot = PROJECT_ROOT;
+
+/**
+ * @brief Fraction of ground-truth boxes matched by a detection with IoU of at
+ * least 0.5.
+ */
+double recall(const std::vector<cv::Rect>& truth,
+              const std::vector<cv::Rect>& detections) {
+  if (truth.empty()) {
+    return 1.0;
+  }
+  int matched = 0;
+  for (const auto& gt : truth) {
+    for (const auto& det : detections) {
+      int intersection = (gt & det).area();
+      int unionArea = gt.area() + det.area() - intersection;
+      if (unionArea > 0 && intersection >= 0.5 * unionArea) {
+        ++matched;
+        break;
+      }
+    }
+  }
+  return static_cast<double>(matched) / truth.size();
+}
+
+/**
+ * @brief Compare the single downscaled pass against tiled detection.
+ * @param iterations Number of timed runs per mode.
+ * @return Process exit code.
+ */
+int benchTiling(int iterations) {
+  detectHuman detector(kProjectRoot + "/yolo_classes/yolov3.weights",
+                       kProjectRoot + "/yolo_classes/yolov3.cfg",
+                       kProjectRoot + "/yolo_classes/coco.names");
+  detector.loadFromFile();
+
+  cv::Mat person = cv::imread(kProjectRoot + "/yolo_classes/bus.jpg");
+  if (person.empty()) {
+    std::cerr << "Failed to load bus.jpg" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // People found at native size are the ground truth once shrunk
+  std::vector<cv::Rect> reference = detector.detectHumans(person);
+
+  // Paste shrunken copies of the scene onto a 4K canvas, as if far away
+  const double scale = 0.2;
+  cv::Mat canvas(2160, 3840, CV_8UC3, cv::Scalar(114, 114, 114));
+  cv::Mat small;
+  cv::resize(person, small, cv::Size(), scale, scale, cv::INTER_AREA);
+  std::vector<cv::Rect> truth;
+  for (int y = 100; y + small.rows < canvas.rows; y += 2 * small.rows) {
+    for (int x = 100; x + small.cols < canvas.cols; x += 2 * small.cols) {
+      small.copyTo(canvas(cv::Rect(x, y, small.cols, small.rows)));
+      for (const auto& box : reference) {
+        truth.emplace_back(x + static_cast<int>(box.x * scale),
+                           y + static_cast<int>(box.y * scale),
+                           static_cast<int>(box.width * scale),
+                           static_cast<int>(box.height * scale));
+      }
+    }
+  }
+
+  TilingConfig config;
+  std::vector<cv::Rect> singleResult;
+  std::vector<cv::Rect> tiledResult;
+
+  int64_t start = cv::getTickCount();
+  for (int i = 0; i < iterations; ++i) {
+    singleResult = detector.detectHumans(canvas);
+  }
+  double singleSeconds =
+      (cv::getTickCount() - start) / cv::getTickFrequency() / iterations;
+
+  start = cv::getTickCount();
+  for (int i = 0; i < iterations; ++i) {
+    tiledResult = detector.detectHumansTiled(canvas, config);
+  }
+  double tiledSeconds =
+      (cv::getTickCount() - start) / cv::getTickFrequency() / iterations;
+
+  std::cout << std::fixed << std::setprecision(3) << "\n"
+            << "Canvas " << canvas.cols << "x" << canvas.rows << ", "
+            << truth.size() << " ground-truth people, "
+            << computeTiles(canvas.size(), config).size() << " tiles\n"
+            << "mode      fps     recall\n"
+            << "single    " << 1.0 / singleSeconds << "   "
+            << recall(truth, singleResult) << "\n"
+            << "tiled     " << 1.0 / tiledSeconds << "   "
+            << recall(truth, tiledResult) << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Build the three YOLOv3 output matrices for a 416x416 input.
+ * @details Rows get low background objectness; about one row in a hundred is
+ * a confident object, half of them people, as in a busy scene.
+ */
+std::vector<cv::Mat> syntheticYoloOutputs(cv::RNG& rng) {
+  const int kClasses = 80;
+  std::vector<cv::Mat> outs;
+  for (int rows : {507, 2028, 8112}) {
+    cv::Mat out(rows, 5 + kClasses, CV_32F, cv::Scalar(0));
+    for (int i = 0; i < rows; ++i) {
+      float* row = out.ptr<float>(i);
+      row[0] = rng.uniform(0.0f, 1.0f);
+      row[1] = rng.uniform(0.0f, 1.0f);
+      row[2] = rng.uniform(0.02f, 0.3f);
+      row[3] = rng.uniform(0.05f, 0.6f);
+      bool object = rng.uniform(0, 100) == 0;
+      row[4] = object ? rng.uniform(0.6f, 0.99f) : rng.uniform(0.0f, 0.05f);
+      int cls = object && rng.uniform(0, 2) == 0 ? 0
+                                                 : rng.uniform(1, kClasses);
+      row[5 + cls] = row[4] * rng.uniform(0.8f, 1.0f);
+    }
+    outs.push_back(out);
+  }
+  return outs;
+}
+
+/**
+ * @brief Time the decode loop of a detector over a set of output tensors.
+ * @return Microseconds per frame and number of boxes decoded per frame.
+ */
+template <class DetectorType>
+std::pair<double, size_t> timeDecode(const DetectorType& detector,
+                                     const std::vector<cv::Mat>& outs,
+                                     int iterations) {
+  const cv::Rect frame(0, 0, 1280, 720);
+  std::pmr::vector<cv::Rect> boxes;
+  std::pmr::vector<float> confidences;
+  int64_t start = cv::getTickCount();
+  for (int i = 0; i < iterations; ++i) {
+    boxes.clear();
+    confidences.clear();
+    for (const auto& out : outs) {
+      detector.decode(out, frame, 0.5f, boxes, confidences);
+    }
+  }
+  double seconds = (cv::getTickCount() - start) / cv::getTickFrequency();
+  return {1e6 * seconds / iterations, boxes.size()};
+}
+
+/**
+ * @brief Compare the specialized person-only decode loop with the generic
+ * runtime-configured one.
+ * @param iterations Number of timed frames per detector.
+ * @return Process exit code.
+ */
+int benchDecode(int iterations) {
+  cv::RNG rng(26);
+  std::vector<cv::Mat> outs = syntheticYoloOutputs(rng);
+
+  // Only the decode loop runs, so no model has to be loaded
+  detectHuman specialized("", "", "");
+  GenericDetector generic("", "", "", ClassSet(std::vector<int>{0}));
+
+  auto [specializedUs, specializedBoxes] =
+      timeDecode(specialized, outs, iterations);
+  auto [genericUs, genericBoxes] = timeDecode(generic, outs, iterations);
+
+  std::cout << std::fixed << std::setprecision(1) << "\n"
+            << "detector      us/frame   boxes\n"
+            << "PersonOnly    " << specializedUs << "      "
+            << specializedBoxes << "\n"
+            << "Generic       " << genericUs << "      " << genericBoxes
+            << "\n"
+            << "speedup       " << genericUs / specializedUs << "x"
+            << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Run the tracker on synthetic scenes of growing crowd size.
+ * @param iterations Number of timed frames per crowd size.
+ * @return Process exit code.
+ */
+int benchSynthetic(int iterations) {
+  const cv::Size frameSize(1280, 720);
+  cv::Mat background(frameSize, CV_8UC3);
+  cv::RNG rng(34);
+  rng.fill(background, cv::RNG::UNIFORM, cv::Scalar::all(40),
+           cv::Scalar::all(90));
+
+  std::vector<std::pair<int, double>> results;
+  for (int people : {1, 5, 20, 50}) {
+    SyntheticSceneConfig scene;
+    scene.people = people;
+    auto engine = std::make_shared<SyntheticEngine>(scene);
+    Tracker tracker("", "", "", cv::Mat());
+    tracker.setEngine(engine);
+
+    cv::Mat frame;
+    int64_t start = cv::getTickCount();
+    for (int i = 0; i < iterations; ++i) {
+      background.copyTo(frame);
+      engine->render(frame);
+      tracker.Track(frame);
+    }
+    double seconds = (cv::getTickCount() - start) / cv::getTickFrequency();
+    results.emplace_back(people, iterations / seconds);
+  }
+
+  std::cout << std::fixed << std::setprecision(1) << "\n"
+            << "people    fps\n";
+  for (const auto& [people, fps] : results) {
+    std::cout << std::setw(6) << people << "    " << fps << "\n";
+  }
+  std::cout << std::flush;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Count detections that overlap no track, testing every pair; a new
+ * detection becomes a track for the detections after it.
+ * @param boxes Reused buffer for the tracks and the new tracks.
+ */
+int associateNested(const std::vector<cv::Rect>& tracks,
+                    const std::vector<cv::Rect>& detections,
+                    std::vector<cv::Rect>& boxes) {
+  boxes.assign(tracks.begin(), tracks.end());
+  int created = 0;
+  for (const auto& det : detections) {
+    bool isNew = true;
+    for (const auto& box : boxes) {
+      if ((det & box).area() > 0) {
+        isNew = false;
+        break;
+      }
+    }
+    if (isNew) {
+      boxes.push_back(det);
+      ++created;
+    }
+  }
+  return created;
+}
+
+/**
+ * @brief Count detections that overlap no track with the association of
+ * Tracker::updateTrackers.
+ * @param boxes Reused buffer for the tracks and the new tracks.
+ */
+int associateGrid(const std::vector<cv::Rect>& tracks,
+                  const std::vector<cv::Rect>& detections, SpatialGrid& grid,
+                  std::vector<cv::Rect>& boxes) {
+  boxes.assign(tracks.begin(), tracks.end());
+  return static_cast<int>(grid.associate(
+      tracks.size(), [&boxes](int i) { return boxes[i]; }, detections,
+      [&boxes](const cv::Rect& det) {
+        boxes.push_back(det);
+        return static_cast<int>(boxes.size()) - 1;
+      }));
+}
+
+/**
+ * @brief Time association on synthetic crowds of growing size.
+ * @param iterations Number of timed frames per crowd size.
+ * @return Process exit code.
+ */
+int benchAssociation(int iterations) {
+  const cv::Size frameSize(1920, 1080);
+  struct Row {
+    int people;
+    double nestedMicros;
+    double gridMicros;
+  };
+  std::vector<Row> rows;
+  for (int people : {10, 20, 50, 100, 200, 500}) {
+    // Smaller people in bigger crowds, as from a camera further away
+    SyntheticSceneConfig scene;
+    scene.people = people;
+    scene.minHeight = people > 100 ? 0.05f : 0.1f;
+    scene.maxHeight = people > 100 ? 0.12f : 0.3f;
+    scene.outputRows = {std::max(507, people * scene.rowsPerPerson)};
+    SyntheticEngine engine(scene);
+
+    // Tracks from one frame, detections from the next, plus a tenth of the
+    // people entering the scene
+    std::vector<cv::Rect> tracks = engine.groundTruth(frameSize);
+    std::vector<cv::Mat> outs;
+    engine.forward(cv::Mat(), outs);
+    std::vector<cv::Rect> detections = engine.groundTruth(frameSize);
+    tracks.resize(tracks.size() - tracks.size() / 10);
+
+    SpatialGrid grid;
+    std::vector<cv::Rect> boxes;
+    int nestedCreated = 0;
+    int gridCreated = 0;
+    int64_t start = cv::getTickCount();
+    for (int i = 0; i < iterations; ++i) {
+      nestedCreated = associateNested(tracks, detections, boxes);
+    }
+    double nested = (cv::getTickCount() - start) / cv::getTickFrequency();
+    start = cv::getTickCount();
+    for (int i = 0; i < iterations; ++i) {
+      gridCreated = associateGrid(tracks, detections, grid, boxes);
+    }
+    double gridded = (cv::getTickCount() - start) / cv::getTickFrequency();
+
+    if (nestedCreated != gridCreated) {
+      std::cerr << "Grid association disagrees with the nested loop for "
+                << people << " people" << std::endl;
+      return EXIT_FAILURE;
+    }
+    rows.push_back({people, 1e6 * nested / iterations,
+                    1e6 * gridded / iterations});
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << "\n"
+            << "people   nested us   grid us   nested us/person   "
+               "grid us/person\n";
+  for (const auto& row : rows) {
+    std::cout << std::setw(6) << row.people << std::setw(12)
+              << row.nestedMicros << std::setw(10) << row.gridMicros
+              << std::setw(19) << row.nestedMicros / row.people
+              << std::setw(17) << row.gridMicros / row.people << "\n";
+  }
+  std::cout << std::flush;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Time tracker updates for several tracking images.
+ * @param iterations Number of timed frames per configuration.
+ * @return Process exit code.
+ */
+int benchTracking(int iterations) {
+  const cv::Size frameSize(1280, 720);
+  cv::Mat background(frameSize, CV_8UC3);
+  cv::RNG rng(41);
+  rng.fill(background, cv::RNG::UNIFORM, cv::Scalar::all(40),
+           cv::Scalar::all(90));
+
+  struct Row {
+    const char* name;
+    FrameCacheConfig config;
+    double microsPerUpdate;
+  };
+  std::vector<Row> rows = {{"colour 1.0", {1.0, false}, 0.0},
+                           {"gray 1.0", {1.0, true}, 0.0},
+                           {"colour 0.5", {0.5, false}, 0.0},
+                           {"gray 0.5", {0.5, true}, 0.0}};
+  for (auto& row : rows) {
+    SyntheticSceneConfig scene;
+    scene.people = 20;
+    auto engine = std::make_shared<SyntheticEngine>(scene);
+    Tracker tracker("", "", "", cv::Mat());
+    tracker.setEngine(engine);
+    tracker.setFrameCache(row.config);
+    tracker.setDrawOverlays(false);
+
+    // Detect once, then only the trackers run
+    cv::Mat frame;
+    background.copyTo(frame);
+    engine->render(frame);
+    tracker.Track(frame);
+    std::vector<cv::Rect> none;
+
+    size_t updates = 0;
+    int64_t elapsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+      background.copyTo(frame);
+      engine->render(frame);
+      std::vector<cv::Mat> outs;
+      engine->forward(cv::Mat(), outs);  // Move the people
+      updates += tracker.activeTrackCount();
+      int64_t start = cv::getTickCount();
+      tracker.updateTrackers(none, frame);
+      elapsed += cv::getTickCount() - start;
+    }
+    row.microsPerUpdate =
+        updates > 0 ? 1e6 * elapsed / cv::getTickFrequency() / updates : 0.0;
+  }
+
+  std::cout << std::fixed << std::setprecision(1) << "\n"
+            << "tracking image   us/track update\n";
+  for (const auto& row : rows) {
+    std::cout << std::left << std::setw(17) << row.name << std::right
+              << row.microsPerUpdate << "\n";
+  }
+  std::cout << std::flush;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Profile the network's layers on repeated detections of bus.jpg.
+ * @param iterations Number of profiled forward passes.
+ * @return Process exit code.
+ */
+int benchLayers(int iterations) {
+  detectHuman detector(kProjectRoot + "/yolo_classes/yolov3.weights",
+                       kProjectRoot + "/yolo_classes/yolov3.cfg",
+                       kProjectRoot + "/yolo_classes/coco.names");
+  detector.loadFromFile();
+
+  cv::Mat image = cv::imread(kProjectRoot + "/yolo_classes/bus.jpg");
+  if (image.empty()) {
+    std::cerr << "Failed to load bus.jpg" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The first pass sets up the network and is not representative
+  detector.detectHumans(image);
+  LayerProfiler& profiler = detector.profileLayers(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    detector.detectHumans(image);
+  }
+
+  std::cout << "\n" << profiler.textReport() << std::flush;
+  profiler.writeJson("layer_profile.json");
+  std::cout << "Full profile written to layer_profile.json" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string mode = argc > 1 ? argv[1] : "tiling";
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+  if (iterations <= 0) {
+    iterations = 1;
+  }
+
+  if (mode == "tiling") {
+    return benchTiling(iterations);
+  }
+  if (mode == "decode") {
+    return benchDecode(iterations * 200);
+  }
+  if (mode == "synthetic") {
+    return benchSynthetic(iterations * 20);
+  }
+  if (mode == "association") {
+    return benchAssociation(iterations * 200);
+  }
+  if (mode == "tracking") {
+    return benchTracking(iterations * 20);
+  }
+  if (mode == "layers") {
+    return benchLayers(iterations * 4);
+  }
+
+  std::cerr << "Unknown benchmark mode: " << mode << std::endl;
+  return EXIT_FAILURE;
+}
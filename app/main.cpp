@@ -1,19 +1,118 @@
 // C++ system headers (alphabetical order)
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 // Third-party library headers
 #include <opencv2/opencv.hpp>
 
 // Other/local headers (alphabetical order)
+#include "FrameCache.hpp"
+#include "FrameCapture.hpp"
+#include "FramePool.hpp"
+#include "LatencyStats.hpp"
+#include "LayerProfiler.hpp"
+#include "ReplayHarness.hpp"
+#include "Scheduling.hpp"
+#include "Tracing.hpp"
+#include "TrackPublisher.hpp"
 #include "Tracker.hpp"
+#include "VideoSink.hpp"
 #include "loadModel.hpp"
 
-int main() {
+namespace {
+
+/// Number of tracing toggles requested with SIGUSR1
+volatile std::sig_atomic_t traceToggles = 0;
+
+/**
+ * @brief SIGUSR1 handler; the main loop applies the toggle.
+ */
+void requestTraceToggle(int) { traceToggles = traceToggles + 1; }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // --low-latency: always process the freshest frame and drop stale ones
+  bool lowLatency = false;
+  // --record <dir>: save frames and detections for perception-replay
+  std::string recordDirectory;
+  // --schedule <spec>: core budgets, e.g. inference=0-3@4,tracking=4,capture=5
+  std::string scheduleSpec;
+  // --pin: restrict each component's threads to its cores
+  bool pin = false;
+  // --publish <name>: share each frame's tracks through shared memory
+  std::string publishName;
+  // --headless: no window; pace by the camera instead of waitKey
+  bool headless = false;
+  // --write <file>: encode annotated frames on a writer thread, optionally
+  // only every Nth frame (--write-every N) or frames with people
+  // (--write-people)
+  VideoSinkConfig sinkConfig;
+  // --trace <file>: record a per-stage timeline from the start; 't' in the
+  // window or SIGUSR1 toggles recording at any time
+  std::string traceFile = "pipeline_trace.json";
+  // --profile-layers <N>: per-layer forward time, FLOPs and memory of the
+  // network over N detector passes after the first, written to
+  // layer_profile.json
+  int profileFrames = 0;
+  // --track-scale <s>: run the trackers at s times the frame resolution;
+  // --track-gray: on a grayscale copy shared by all tracks
+  FrameCacheConfig trackingConfig;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--low-latency") {
+      lowLatency = true;
+    } else if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+      recordDirectory = argv[++i];
+    } else if (std::string(argv[i]) == "--schedule" && i + 1 < argc) {
+      scheduleSpec = argv[++i];
+    } else if (std::string(argv[i]) == "--pin") {
+      pin = true;
+    } else if (std::string(argv[i]) == "--publish" && i + 1 < argc) {
+      publishName = argv[++i];
+    } else if (std::string(argv[i]) == "--headless") {
+      headless = true;
+    } else if (std::string(argv[i]) == "--write" && i + 1 < argc) {
+      sinkConfig.path = argv[++i];
+    } else if (std::string(argv[i]) == "--write-every" && i + 1 < argc) {
+      sinkConfig.everyNth = std::max(1, std::atoi(argv[++i]));
+    } else if (std::string(argv[i]) == "--write-people") {
+      sinkConfig.onlyWithPeople = true;
+    } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+      traceFile = argv[++i];
+      Tracing::setEnabled(true);
+    } else if (std::string(argv[i]) == "--profile-layers" && i + 1 < argc) {
+      profileFrames = std::max(1, std::atoi(argv[++i]));
+    } else if (std::string(argv[i]) == "--track-scale" && i + 1 < argc) {
+      trackingConfig.scale = std::atof(argv[++i]);
+    } else if (std::string(argv[i]) == "--track-gray") {
+      trackingConfig.grayscale = true;
+    }
+  }
+
+  std::unique_ptr<Scheduler> scheduler;
+  try {
+    SchedulingConfig schedule = SchedulingConfig::parse(scheduleSpec);
+    schedule.pin = pin;
+    scheduler = std::make_unique<Scheduler>(schedule);
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Invalid --schedule: " << e.what() << std::endl;
+    return -1;
+  }
+
   cv::VideoCapture cap(0);  // Open the default camera
   if (!cap.isOpened()) {
     std::cerr << "Error opening video capture" << std::endl;
     return -1;
   }
+  if (lowLatency) {
+    // Keep the driver from queueing frames behind our back
+    cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
+  }
 
   // Use relative paths
   std::string modelPath =
@@ -26,9 +125,56 @@ int main() {
       "/home/navdeep/Project/Monocular-Human-Detection-YOLO/yolo_classes/"
       "coco.names";
 
-  cv::Mat frame;
-  Tracker tracker(modelPath, config_path, coco_path, frame);
+  // Decode straight into a bounded set of preallocated frame buffers on a
+  // capture thread; stages below borrow the slots without copying
+  cv::Size frameSize(static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)),
+                     static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+  FramePool pool(4, frameSize, CV_8UC3);
+  FrameCapture capture(
+      pool, [&cap](cv::Mat& slot) { return cap.read(slot); }, lowLatency ? 1 : 2,
+      lowLatency ? CapturePolicy::kLatestFrame : CapturePolicy::kEveryFrame);
+  capture.setThreadHooks(
+      [&scheduler] {
+        scheduler->enter(Component::kCapture);
+        Tracing::setThreadName("capture");
+      },
+      [&scheduler] { scheduler->leave(); });
+  Tracing::setThreadName("main");
+  std::signal(SIGUSR1, requestTraceToggle);
+  std::sig_atomic_t tracesApplied = 0;
+  LatencyStats latency;
+  std::unique_ptr<SequenceRecorder> recorder;
+  if (!recordDirectory.empty()) {
+    recorder = std::make_unique<SequenceRecorder>(recordDirectory);
+  }
+  std::unique_ptr<VideoSink> sink;
+  if (!sinkConfig.path.empty()) {
+    // Without a window nothing else needs Track's overlays, so the sink
+    // draws them on its own thread
+    sinkConfig.fps = cap.get(cv::CAP_PROP_FPS) > 0 ? cap.get(cv::CAP_PROP_FPS)
+                                                  : 30.0;
+    sinkConfig.drawOverlays = headless;
+    sink = std::make_unique<VideoSink>(sinkConfig);
+  }
+  std::unique_ptr<TrackPublisher> publisher;
+  if (!publishName.empty()) {
+    publisher = std::make_unique<TrackPublisher>(publishName);
+  }
+  cv::Mat rawFrame;
+  std::vector<AnnotatedTrack> sinkTracks;
+
+  Tracker tracker(modelPath, config_path, coco_path, cv::Mat());
   tracker.loadFromFile();
+  try {
+    tracker.setFrameCache(trackingConfig);
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Invalid --track-scale: " << e.what() << std::endl;
+    return -1;
+  }
+  tracker.enableMotionGating();
+  tracker.setScheduler(scheduler.get());
+  tracker.setDrawOverlays(!headless);
+  capture.start();
 
   // Get start time
   int64_t start_time = cv::getTickCount();
@@ -46,21 +192,61 @@ int main() {
       break;
     }
 
-    cap >> frame;
-    if (frame.empty()) {
+    if (traceToggles != tracesApplied) {
+      tracesApplied = traceToggles;
+      Tracing::setEnabled(!Tracing::enabled());
+    }
+
+    FrameHandle handle;
+    {
+      TraceScope scope("wait for frame");
+      handle = capture.next();
+    }
+    if (!handle || handle.mat().empty()) {
       std::cerr << "Error capturing frame" << std::endl;
       break;
     }
+    cv::Mat& frame = handle.mat();
+    TraceScope frameScope("frame", static_cast<int64_t>(handle.sequence()));
 
-    // Display remaining time
-    int remaining_time = DURATION_SECONDS - elapsed_time;
-    cv::putText(
-        frame, "Stopping tracking after" + std::to_string(remaining_time) + "s",
-        cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0),
-        2);
-
+    // Track draws on the frame, so keep the camera pixels for the recording
+    if (recorder) {
+      frame.copyTo(rawFrame);
+    }
     tracker.Track(frame);
-    cv::imshow("Human Detector and Tracker", frame);
+    latency.recordSince(handle.captureTime());
+    if (profileFrames > 0 && !tracker.getLayerProfiler()) {
+      // The first pass sets up the network and is not representative
+      tracker.profileLayers(profileFrames);
+    }
+    if (publisher) {
+      publisher->publish(tracker, handle.captureTime());
+    }
+    if (sink) {
+      annotatedTracks(tracker, sinkTracks);
+      sink->submit(frame, sinkTracks);
+    }
+    if (recorder) {
+      recorder->record(rawFrame, tracker.getDetections());
+    }
+
+    if (headless) {
+      continue;
+    }
+
+    // Display remaining time (after tracking, so the motion gate and the
+    // detector only ever see camera pixels)
+    scheduler->enter(Component::kRender);
+    {
+      TraceScope scope("render");
+      int remaining_time = DURATION_SECONDS - elapsed_time;
+      cv::putText(frame,
+                  "Stopping tracking after" + std::to_string(remaining_time) +
+                      "s",
+                  cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 1.0,
+                  cv::Scalar(0, 255, 0), 2);
+      cv::imshow("Human Detector and Tracker", frame);
+    }
 
     // Check for key press with a small wait
     char key = cv::waitKey(30);
@@ -68,11 +254,70 @@ int main() {
       std::cout << "Manual stop triggered" << std::endl;
       break;
     }
+    if (key == 't') {
+      Tracing::setEnabled(!Tracing::enabled());
+      std::cout << "Tracing " << (Tracing::enabled() ? "on" : "off")
+                << std::endl;
+    }
+  }
+
+  std::cout << "Detector skipped on "
+            << tracker.getMotionGate().framesSkipped() << " of "
+            << tracker.getMotionGate().framesSeen() << " frames ("
+            << 100.0 * tracker.getMotionGate().skipRate() << "%)" << std::endl;
+
+  std::cout << latency.summary("Capture-to-result latency") << std::endl;
+  std::cout << "Frames captured: " << capture.framesCaptured()
+            << ", dropped as stale: " << capture.framesDropped() << std::endl;
+
+  std::cout << "CPU use per component:\n" << scheduler->report() << std::endl;
+
+  if (sink) {
+    sink->close();
+    std::cout << "Video frames written to " << sinkConfig.path << ": "
+              << sink->framesWritten() << ", dropped: " << sink->framesDropped()
+              << ", skipped: " << sink->framesFiltered() << std::endl;
+  }
+
+  if (Tracing::eventCount() > 0) {
+    Tracing::setEnabled(false);
+    try {
+      std::cout << "Wrote " << Tracing::writeChromeTrace(traceFile)
+                << " trace events to " << traceFile << " (overwritten "
+                << Tracing::droppedCount() << "); open it in ui.perfetto.dev"
+                << std::endl;
+    } catch (const std::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
+  if (const LayerProfiler* profiler = tracker.getLayerProfiler()) {
+    std::cout << profiler->textReport() << std::endl;
+    try {
+      profiler->writeJson("layer_profile.json");
+      std::cout << "Wrote layer profile to layer_profile.json" << std::endl;
+    } catch (const std::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
+  if (recorder) {
+    std::cout << "Recorded " << recorder->framesRecorded() << " frames to "
+              << recordDirectory << std::endl;
+  }
+
+  if (pool.allocations() > 0) {
+    std::cout << "Frame pool reallocated " << pool.allocations()
+              << " slot(s); camera size differs from " << frameSize
+              << std::endl;
   }
 
   // Cleanup
+  capture.stop();
   cap.release();
-  cv::destroyAllWindows();
+  if (!headless) {
+    cv::destroyAllWindows();
+  }
 
   return 0;
 }
@@ -0,0 +1,180 @@
+/**
+ * @file replay.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Record-and-replay regression runner for the tracking pipeline.
+ * @details Usage:
+ *          - perception-replay synthetic <dir> [frames]
+ *            Writes a scripted scene of textured people walking across a
+ *            static background, with their true boxes recorded as the
+ *            detector output. Needs no model weights.
+ *          - perception-replay check <dir> <golden> [--min-fps N]
+ *            [--tolerance PX] [--update-golden]
+ *            Replays a recorded sequence (from the synthetic mode or from
+ *            shell-app --record) through Tracker, compares the tracks with
+ *            the golden file and fails below the frame-rate floor. A missing
+ *            golden file is an error; --update-golden (re)writes it from
+ *            the replay instead of comparing.
+ * @version 0.1
+ * @date 2024-11-18
+ */
+
+// C++ system headers (alphabetical order)
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Third-party library headers
+#include <opencv2/opencv.hpp>
+
+// Other/local headers (alphabetical order)
+#include "LatencyStats.hpp"
+#include "ReplayHarness.hpp"
+#include "Tracker.hpp"
+
+namespace {
+
+/**
+ * @brief Record a scripted scene with known boxes.
+ * @param directory Output sequence directory.
+ * @param frames Number of frames to record.
+ */
+int writeSynthetic(const std::string& directory, int frames) {
+  const cv::Size frameSize(640, 360);
+  cv::RNG rng(33);
+
+  // Static textured background, so trackers have something to lock on to
+  cv::Mat background(frameSize, CV_8UC3);
+  rng.fill(background, cv::RNG::UNIFORM, cv::Scalar::all(40),
+           cv::Scalar::all(90));
+
+  struct Walker {
+    cv::Mat texture;
+    cv::Point2f start;
+    cv::Point2f velocity;
+  };
+  const cv::Size personSize(40, 100);
+  std::vector<Walker> walkers;
+  for (int i = 0; i < 4; ++i) {
+    Walker walker;
+    walker.texture.create(personSize, CV_8UC3);
+    rng.fill(walker.texture, cv::RNG::UNIFORM, cv::Scalar::all(120),
+             cv::Scalar::all(255));
+    walker.start = cv::Point2f(60.0f + 140.0f * i, 40.0f + 50.0f * (i % 3));
+    // Same direction and speed, so walkers never occlude each other and the
+    // tracks do not depend on how a tracker handles crossings
+    walker.velocity = cv::Point2f(1.0f, 0.5f);
+    walkers.push_back(walker);
+  }
+
+  SequenceRecorder recorder(directory);
+  const cv::Rect frameRect(cv::Point(0, 0), frameSize);
+  cv::Mat frame;
+  for (int f = 0; f < frames; ++f) {
+    background.copyTo(frame);
+    std::vector<cv::Rect> boxes;
+    for (const auto& walker : walkers) {
+      cv::Point2f position = walker.start + walker.velocity * f;
+      cv::Rect box(cv::Point(static_cast<int>(position.x),
+                             static_cast<int>(position.y)),
+                   personSize);
+      if ((box & frameRect) != box) {
+        continue;
+      }
+      walker.texture.copyTo(frame(box));
+      boxes.push_back(box);
+    }
+    recorder.record(frame, boxes);
+  }
+  std::cout << "Recorded " << recorder.framesRecorded() << " frames to "
+            << directory << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Replay a sequence and check tracks and frame rate.
+ */
+int check(const std::string& directory, const std::string& golden,
+          double minFps, int tolerance, bool updateGolden) {
+  LatencyStats decodeLatency;
+  RecordedSequence sequence = RecordedSequence::load(directory, &decodeLatency);
+
+  // Detections come from the recording, so no model is loaded
+  Tracker tracker("", "", "", cv::Mat());
+  ReplayReport report = replaySequence(tracker, sequence);
+
+  std::cout << "Replayed " << report.frames << " frames at " << report.fps
+            << " fps (floor " << minFps << ")\n"
+            << decodeLatency.summary("decode") << "\n"
+            << report.trackLatency.summary("track") << std::endl;
+
+  if (updateGolden) {
+    writeTracks(golden, report.tracks);
+    std::cout << "Wrote golden tracks to " << golden << std::endl;
+  } else if (!std::filesystem::exists(golden)) {
+    std::cerr << "Missing golden file " << golden
+              << "; create it with --update-golden" << std::endl;
+    return EXIT_FAILURE;
+  } else {
+    std::vector<std::string> mismatches =
+        compareTracks(report.tracks, readTracks(golden), tolerance);
+    for (const auto& mismatch : mismatches) {
+      std::cerr << mismatch << "\n";
+    }
+    if (!mismatches.empty()) {
+      std::cerr << mismatches.size() << " mismatches against " << golden
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (report.fps < minFps) {
+    std::cerr << "Replay ran at " << report.fps << " fps, below the floor of "
+              << minFps << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string mode = argc > 1 ? argv[1] : "";
+
+  if (mode == "synthetic" && argc > 2) {
+    int frames = argc > 3 ? std::atoi(argv[3]) : 120;
+    return writeSynthetic(argv[2], frames > 0 ? frames : 120);
+  }
+
+  if (mode == "check" && argc > 3) {
+    double minFps = 0.0;
+    int tolerance = 2;
+    bool updateGolden = false;
+    for (int i = 4; i < argc; ++i) {
+      std::string arg = argv[i];
+      if (arg == "--min-fps" && i + 1 < argc) {
+        minFps = std::atof(argv[++i]);
+      } else if (arg == "--tolerance" && i + 1 < argc) {
+        tolerance = std::atoi(argv[++i]);
+      } else if (arg == "--update-golden") {
+        updateGolden = true;
+      } else {
+        std::cerr << "Unknown option: " << arg << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    try {
+      return check(argv[2], argv[3], minFps, tolerance, updateGolden);
+    } catch (const std::exception& e) {
+      std::cerr << "Replay failed: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cerr << "Usage: perception-replay synthetic <dir> [frames]\n"
+            << "       perception-replay check <dir> <golden> [--min-fps N]"
+            << " [--tolerance PX] [--update-golden]" << std::endl;
+  return EXIT_FAILURE;
+}
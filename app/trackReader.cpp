@@ -0,0 +1,69 @@
+/**
+ * @file trackReader.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Example consumer of the shared-memory track ring.
+ * @details Usage: perception-track-reader [name] [frames]
+ *          Prints every frame published by shell-app --publish and, at
+ *          the end, the publish-to-read and capture-to-read latencies. Links
+ *          only the track_reader library.
+ * @version 0.1
+ * @date 2024-11-21
+ */
+
+// C++ system headers (alphabetical order)
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+// Other/local headers (alphabetical order)
+#include "TrackRing.hpp"
+
+int main(int argc, char** argv) {
+  const std::string name = argc > 1 ? argv[1] : "/perception_tracks";
+  const long frames = argc > 2 ? std::atol(argv[2]) : 0;
+
+  try {
+    TrackSubscriber subscriber(name);
+    TrackFrame frame;
+    long read = 0;
+    double publishTotal = 0.0;
+    double captureTotal = 0.0;
+    long captureCount = 0;
+    while ((frames <= 0 || read < frames) &&
+           subscriber.waitNext(frame, std::chrono::seconds(5))) {
+      const int64_t now = sharedClockNanos();
+      publishTotal += (now - frame.published) / 1e6;
+      if (frame.captured != 0) {
+        captureTotal += (now - frame.captured) / 1e6;
+        ++captureCount;
+      }
+      ++read;
+
+      std::cout << "frame " << frame.frame << ": " << frame.count
+                << " track(s)";
+      for (uint32_t i = 0; i < frame.count; ++i) {
+        const SharedTrack& track = frame.tracks[i];
+        std::cout << " [" << track.id << " at (" << track.position[0] << ", "
+                  << track.position[1] << ", " << track.position[2] << ")]";
+      }
+      std::cout << "\n";
+    }
+
+    std::cout << "Read " << read << " frames, lost " << subscriber.framesLost()
+              << std::endl;
+    if (read > 0) {
+      std::cout << "Mean publish-to-read latency " << publishTotal / read
+                << " ms" << std::endl;
+    }
+    if (captureCount > 0) {
+      std::cout << "Mean capture-to-read latency "
+                << captureTotal / captureCount << " ms" << std::endl;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Track reader failed: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
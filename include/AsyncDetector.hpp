@@ -0,0 +1,209 @@
+/**
+ * @file AsyncDetector.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the AsyncDetector class, a non-blocking front end
+ * that runs detection on a dedicated executor thread.
+ * @details A control loop submits frames and gets the result later through a
+ * std::future or a completion callback, so it never stalls on a forward
+ * pass. The number of requests in flight is bounded; when the bound is hit
+ * the oldest queued request is cancelled in favour of the new frame, and
+ * requests that waited longer than the configured maximum age are cancelled
+ * instead of being run.
+ * @version 0.1
+ * @date 2024-11-15
+ */
+
+#ifndef ASYNC_DETECTOR_HPP
+#define ASYNC_DETECTOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "FramePool.hpp"
+
+/**
+ * @struct DetectionResult
+ * @brief Outcome of one asynchronous detection request.
+ */
+struct DetectionResult {
+  uint64_t requestId = 0;  ///< Id returned in submission order.
+  bool cancelled = false;  ///< True if the request was dropped unrun.
+  std::vector<cv::Rect> detections;  ///< Detections, empty if cancelled.
+  std::exception_ptr error;  ///< Set if the detection function threw.
+  std::chrono::steady_clock::time_point submitted;  ///< Submission time.
+  std::chrono::steady_clock::time_point completed;  ///< Completion time.
+};
+
+/**
+ * @struct AsyncDetectorConfig
+ * @brief Limits of the asynchronous detector.
+ */
+struct AsyncDetectorConfig {
+  /**
+   * @brief Largest number of requests queued or running at once.
+   */
+  size_t maxInFlight = 2;
+
+  /**
+   * @brief Queued requests older than this are cancelled instead of run.
+   * Zero disables the age limit.
+   */
+  std::chrono::milliseconds maxAge{0};
+
+  /**
+   * @brief Called on the executor thread before its first request, e.g. to
+   * register it with a Scheduler. Optional.
+   */
+  std::function<void()> threadStart;
+
+  /**
+   * @brief Called on the executor thread right before it exits. Optional.
+   */
+  std::function<void()> threadExit;
+};
+
+/**
+ * @class AsyncDetector
+ * @brief Runs a detection function on its own executor thread.
+ * @details The wrapped function (e.g. detectHuman::detectHumans, or a lambda
+ * around Tracker::Track) is only ever called from the executor thread, so
+ * the detector it uses must not be called from elsewhere while the
+ * AsyncDetector is alive. Callbacks run on the executor thread, except for
+ * requests cancelled inside submit() or cancelPending(), whose callbacks run
+ * on the calling thread.
+ */
+class AsyncDetector {
+ public:
+  /// Detection function run on the executor thread.
+  using DetectFunction = std::function<std::vector<cv::Rect>(const cv::Mat&)>;
+
+  /// Completion callback.
+  using Callback = std::function<void(const DetectionResult&)>;
+
+  /**
+   * @brief Constructor for the AsyncDetector class; starts the executor.
+   * @param detect Detection function to run.
+   * @param config In-flight and age limits.
+   */
+  explicit AsyncDetector(DetectFunction detect,
+                         const AsyncDetectorConfig& config =
+                             AsyncDetectorConfig());
+
+  AsyncDetector(const AsyncDetector&) = delete;
+  AsyncDetector& operator=(const AsyncDetector&) = delete;
+
+  /**
+   * @brief Destructor; cancels queued requests and joins the executor after
+   * the running request finishes.
+   */
+  ~AsyncDetector();
+
+  /**
+   * @brief Submit a frame; never blocks on inference.
+   * @details If the detection function throws, the future rethrows.
+   * @param frame Frame to process. Its pixels are shared, not copied, and
+   * must not be overwritten until the request completes.
+   * @return Future that becomes ready when the request completes or is
+   * cancelled.
+   */
+  std::future<DetectionResult> submit(const cv::Mat& frame);
+
+  /**
+   * @brief Submit a pooled frame; the handle keeps its slot alive until the
+   * request completes.
+   * @param frame Frame to process.
+   * @return Future that becomes ready when the request completes or is
+   * cancelled.
+   */
+  std::future<DetectionResult> submit(const FrameHandle& frame);
+
+  /**
+   * @brief Submit a frame and get the result through a callback.
+   * @param frame Frame to process; its pixels are shared, not copied.
+   * @param onComplete Invoked once with the result or the cancellation; an
+   * exception thrown by the detection function is passed in result.error.
+   * @return Id of the request.
+   */
+  uint64_t submit(const cv::Mat& frame, Callback onComplete);
+
+  /**
+   * @brief Submit a pooled frame and get the result through a callback.
+   * @param frame Frame to process.
+   * @param onComplete Invoked once with the result or the cancellation.
+   * @return Id of the request.
+   */
+  uint64_t submit(const FrameHandle& frame, Callback onComplete);
+
+  /**
+   * @brief Cancel every request that has not started running yet.
+   * @return Number of cancelled requests.
+   */
+  size_t cancelPending();
+
+  /**
+   * @brief Number of requests currently queued, running or being
+   * delivered; a request leaves it once its future is ready or its callback
+   * has returned.
+   */
+  size_t inFlight() const;
+
+  size_t completedCount() const;  ///< Requests run to completion.
+
+  size_t cancelledCount() const;  ///< Requests cancelled unrun.
+
+ private:
+  /**
+   * @struct Request
+   * @brief A queued detection request.
+   */
+  struct Request {
+    DetectionResult result;   ///< Id and timing filled at submission.
+    cv::Mat frame;            ///< Frame header sharing the caller's pixels.
+    FrameHandle handle;       ///< Keeps a pooled frame alive, may be empty.
+    std::shared_ptr<std::promise<DetectionResult>> promise;  ///< For futures.
+    Callback onComplete;      ///< For callbacks.
+  };
+
+  /**
+   * @brief Queue a request, cancelling the oldest one if the bound is hit.
+   */
+  uint64_t enqueue(Request request);
+
+  /**
+   * @brief Deliver a result through the request's promise or callback.
+   */
+  static void finish(Request& request);
+
+  /**
+   * @brief Mark a request cancelled and deliver it.
+   */
+  static void cancel(Request& request);
+
+  /**
+   * @brief Body of the executor thread.
+   */
+  void run();
+
+  DetectFunction detect;           ///< Wrapped detection function.
+  AsyncDetectorConfig config;      ///< In-flight and age limits.
+  std::deque<Request> queue;       ///< Requests waiting to run.
+  bool busy = false;               ///< Whether a request is running.
+  bool stopping = false;           ///< Set when the executor must exit.
+  uint64_t next_id = 0;            ///< Id of the next request.
+  size_t completed = 0;            ///< Requests run to completion.
+  size_t cancelled = 0;            ///< Requests cancelled unrun.
+  mutable std::mutex mutex;        ///< Guards all state above.
+  std::condition_variable wake;    ///< Signals queued work or stop.
+  std::thread executor;            ///< Dedicated executor thread.
+};
+
+#endif  // ASYNC_DETECTOR_HPP
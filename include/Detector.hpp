@@ -3,8 +3,9 @@
  * @author Sachin Jadhav (sjd3333@umd.edu)
  * @brief Header file for the Detector class that handles human detection in
  * images
- * @details This class extends loadModel to provide human detection capabilities
- * using a pre-trained neural network model (YOLO) through OpenCV's DNN module.
+ * @details This class is the runtime-configured instantiation of YoloDetector
+ * (GenericDetector): the kept classes and the thresholds are chosen when the
+ * detector is constructed rather than at compile time.
  * @version 0.1
  * @date 2024-10-30
  */
@@ -17,25 +18,31 @@
 #include <string>
 #include <vector>
 
-#include "loadModel.hpp"
+#include "YoloDetector.hpp"
 
 /**
  * @class Detector
- * @brief A class for detecting humans in images using deep learning
- * @details Inherits from loadModel class and implements human detection using
- *          YOLO (You Only Look Once) neural network architecture.
+ * @brief A class for detecting humans (or any set of classes) in images
+ * using deep learning
+ * @details Uses the generic YoloDetector decode loop, which scans all class
+ *          scores for the best class and checks it against a lookup table
+ *          built from the class names once the labels are loaded.
  */
-class Detector : public loadModel {
+class Detector : public GenericDetector {
  public:
   /**
    * @brief Constructor for the Detector class
    * @param model_file_path Path to the pre-trained neural network model file
    * @param config_file_path Path to the model configuration file
    * @param classes_file_path Path to the file containing class names/labels
+   * @param classNames Names of the classes to keep
+   * @param thresholds Confidence, NMS score and NMS IoU thresholds
    */
   Detector(const std::string& model_file_path,
            const std::string& config_file_path,
-           const std::string& classes_file_path);
+           const std::string& classes_file_path,
+           const std::vector<std::string>& classNames = {"person"},
+           const RuntimeThresholds& thresholds = RuntimeThresholds());
 
   /**
    * @brief Detect humans in the input image
@@ -43,9 +50,6 @@ class Detector : public loadModel {
    * @return std::vector<cv::Rect> Vector of bounding boxes for detected humans
    */
   std::vector<cv::Rect> detectHumans(const cv::Mat& inputImage);
-
-  std::vector<float> confidences;  ///< Confidence scores for detected objects
-  std::vector<cv::Rect> boxes;     ///< Bounding boxes for detected objects
 };
 
-#endif  // DETECTOR_HPP
\ No newline at end of file
+#endif  // DETECTOR_HPP
@@ -0,0 +1,256 @@
+/**
+ * @file DetectorPolicies.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Compile-time policies that configure the YoloDetector template.
+ * @details A detector is assembled from four policies:
+ *          - class filter: which classes are kept (PersonOnly, ClassSet)
+ *          - box layout: how the first four columns encode a box
+ *            (CenterSizeBoxes, CornerBoxes)
+ *          - score mode: how objectness and class score combine
+ *            (ClassScore, ObjectnessTimesClass)
+ *          - thresholds: confidence, score and NMS limits
+ *            (PersonThresholds, RuntimeThresholds)
+ *          Policies with only static members are resolved entirely at compile
+ *          time; the runtime variants carry their configuration as members.
+ * @version 0.1
+ * @date 2024-11-13
+ */
+
+#ifndef DETECTOR_POLICIES_HPP
+#define DETECTOR_POLICIES_HPP
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Class filters
+// ---------------------------------------------------------------------------
+
+/**
+ * @struct SingleClass
+ * @brief Keep one class known at compile time.
+ * @details Reads the score of ClassId directly instead of scanning all class
+ * columns for the maximum, and never looks at class names. A row is kept
+ * when this class alone clears the threshold.
+ * @tparam ClassId Column of the class within the class scores.
+ */
+template <int ClassId>
+struct SingleClass {
+  /**
+   * @brief Nothing to resolve; the class id is a compile-time constant.
+   */
+  void bind(const std::vector<std::string>& /*labels*/) {}
+
+  /**
+   * @brief Always bound.
+   */
+  bool bound() const { return true; }
+
+  /**
+   * @brief Pick the class of a row.
+   * @param scores Class scores of the row.
+   * @param numClasses Number of class columns.
+   * @param classId Receives the selected class id.
+   * @param score Receives the selected class score.
+   * @return Whether the row holds a class this filter keeps.
+   */
+  bool select(const float* scores, int numClasses, int& classId,
+              float& score) const {
+    if (ClassId >= numClasses) {
+      return false;
+    }
+    classId = ClassId;
+    score = scores[ClassId];
+    return true;
+  }
+};
+
+/// Person is class 0 in the COCO label order used by YOLOv3.
+using PersonOnly = SingleClass<0>;
+
+/**
+ * @class ClassSet
+ * @brief Keep any of a set of classes chosen at runtime.
+ * @details Scans all class scores for the best one, then checks it against
+ * a lookup table built once from the class names, so the per-row path never
+ * compares strings.
+ */
+class ClassSet {
+ public:
+  /**
+   * @brief Keep the classes with the given names.
+   * @param names Class names, resolved against the label file by bind().
+   */
+  explicit ClassSet(std::vector<std::string> names = {"person"})
+      : names(std::move(names)) {}
+
+  /**
+   * @brief Keep the classes with the given ids; no binding is needed.
+   * @param ids Class ids (label file line numbers).
+   */
+  explicit ClassSet(const std::vector<int>& ids) {
+    for (int id : ids) {
+      allow(id);
+    }
+  }
+
+  /**
+   * @brief Resolve the class names against the loaded labels.
+   * @param labels Class labels in id order.
+   * @throws std::invalid_argument if a name is not among the labels.
+   */
+  void bind(const std::vector<std::string>& labels) {
+    for (const auto& name : names) {
+      auto it = std::find(labels.begin(), labels.end(), name);
+      if (it == labels.end()) {
+        throw std::invalid_argument("Unknown class name: " + name);
+      }
+      allow(static_cast<int>(it - labels.begin()));
+    }
+    names.clear();
+  }
+
+  /**
+   * @brief Whether all class names have been resolved to ids.
+   */
+  bool bound() const { return names.empty(); }
+
+  /**
+   * @brief Pick the best-scoring class of a row if it is in the set.
+   * @param scores Class scores of the row.
+   * @param numClasses Number of class columns.
+   * @param classId Receives the best class id.
+   * @param score Receives the best class score.
+   * @return Whether the best class is in the set.
+   */
+  bool select(const float* scores, int numClasses, int& classId,
+              float& score) const {
+    int best = 0;
+    for (int c = 1; c < numClasses; ++c) {
+      if (scores[c] > scores[best]) {
+        best = c;
+      }
+    }
+    classId = best;
+    score = scores[best];
+    return best < static_cast<int>(allowed.size()) && allowed[best];
+  }
+
+ private:
+  void allow(int id) {
+    if (id >= static_cast<int>(allowed.size())) {
+      allowed.resize(id + 1, 0);
+    }
+    allowed[id] = 1;
+  }
+
+  std::vector<std::string> names;  ///< Names still to be resolved.
+  std::vector<char> allowed;       ///< allowed[id] != 0 if id is kept.
+};
+
+// ---------------------------------------------------------------------------
+// Box layouts
+// ---------------------------------------------------------------------------
+
+/**
+ * @struct CenterSizeBoxes
+ * @brief Rows start with normalized (center x, center y, width, height), the
+ * layout of OpenCV's Darknet region layer.
+ */
+struct CenterSizeBoxes {
+  /**
+   * @brief Convert the box of a row into pixels of the given region.
+   * @param row Output row.
+   * @param region Frame area the network input was taken from.
+   */
+  static cv::Rect toRect(const float* row, const cv::Rect& region) {
+    int centerX = static_cast<int>(row[0] * region.width);
+    int centerY = static_cast<int>(row[1] * region.height);
+    int width = static_cast<int>(row[2] * region.width);
+    int height = static_cast<int>(row[3] * region.height);
+    return cv::Rect(region.x + centerX - width / 2,
+                    region.y + centerY - height / 2, width, height);
+  }
+};
+
+/**
+ * @struct CornerBoxes
+ * @brief Rows start with normalized (left, top, right, bottom), as emitted
+ * by some exported detectors.
+ */
+struct CornerBoxes {
+  /**
+   * @brief Convert the box of a row into pixels of the given region.
+   * @param row Output row.
+   * @param region Frame area the network input was taken from.
+   */
+  static cv::Rect toRect(const float* row, const cv::Rect& region) {
+    int left = static_cast<int>(row[0] * region.width);
+    int top = static_cast<int>(row[1] * region.height);
+    int right = static_cast<int>(row[2] * region.width);
+    int bottom = static_cast<int>(row[3] * region.height);
+    return cv::Rect(region.x + left, region.y + top, right - left,
+                    bottom - top);
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Score modes
+// ---------------------------------------------------------------------------
+
+/**
+ * @struct ClassScore
+ * @brief Class scores already include objectness, as in OpenCV's region
+ * layer output.
+ */
+struct ClassScore {
+  static float score(float /*objectness*/, float classScore) {
+    return classScore;
+  }
+};
+
+/**
+ * @struct ObjectnessTimesClass
+ * @brief Class scores are conditional probabilities and must be multiplied
+ * by objectness.
+ */
+struct ObjectnessTimesClass {
+  static float score(float objectness, float classScore) {
+    return objectness * classScore;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Thresholds
+// ---------------------------------------------------------------------------
+
+/**
+ * @struct PersonThresholds
+ * @brief Compile-time thresholds of the person tracker: keep rows above 0.5,
+ * run NMS with a 0.7 score threshold and 0.4 IoU.
+ */
+struct PersonThresholds {
+  static constexpr float confidence() { return 0.5f; }
+  static constexpr float score() { return 0.7f; }
+  static constexpr float nms() { return 0.4f; }
+};
+
+/**
+ * @struct RuntimeThresholds
+ * @brief Thresholds chosen at runtime.
+ */
+struct RuntimeThresholds {
+  float confidenceThreshold = 0.5f;  ///< Minimum score to decode a row.
+  float scoreThreshold = 0.5f;       ///< Score threshold given to NMS.
+  float nmsThreshold = 0.4f;         ///< IoU threshold given to NMS.
+
+  float confidence() const { return confidenceThreshold; }
+  float score() const { return scoreThreshold; }
+  float nms() const { return nmsThreshold; }
+};
+
+#endif  // DETECTOR_POLICIES_HPP
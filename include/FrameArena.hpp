@@ -0,0 +1,76 @@
+/**
+ * @file FrameArena.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the FrameArena class, a bump allocator for data that
+ * lives for one frame.
+ * @details Decoded candidates, NMS scratch and per-frame results are
+ * allocated from the arena through std::pmr containers and released all at
+ * once by reset() at the end of the frame. Allocation is a pointer bump and
+ * deallocation is a no-op. If a frame needs more than the block holds, the
+ * excess spills to the heap and the block is grown at the next reset, so
+ * after a few warm-up frames the arena no longer touches the heap.
+ * @version 0.1
+ * @date 2024-11-16
+ */
+
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * @class FrameArena
+ * @brief Monotonic memory resource reset once per frame.
+ * @details Pass the arena itself to std::pmr containers. Containers using it
+ * must be destroyed, or no longer used, before reset(). Not thread-safe.
+ */
+class FrameArena : public std::pmr::memory_resource {
+ public:
+  /**
+   * @brief Constructor for the FrameArena class.
+   * @param capacity Initial block size in bytes.
+   */
+  explicit FrameArena(size_t capacity = 64 * 1024);
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /**
+   * @brief Release everything allocated since the last reset.
+   * @details If the frame spilled past the block, the block is replaced by
+   * one large enough for the whole frame.
+   */
+  void reset();
+
+  size_t capacity() const { return block_size; }  ///< Block size in bytes.
+
+  size_t used() const { return offset + spilled; }  ///< Bytes this frame.
+
+  size_t highWater() const { return high_water; }  ///< Largest frame so far.
+
+  size_t spills() const { return spill_count; }  ///< Heap fallbacks so far.
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+
+  void do_deallocate(void* /*p*/, size_t /*bytes*/,
+                     size_t /*alignment*/) override {}
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  std::unique_ptr<std::byte[]> block;  ///< Preallocated block.
+  size_t block_size;                   ///< Size of the block.
+  size_t offset = 0;                   ///< First free byte in the block.
+  size_t spilled = 0;                  ///< Bytes taken from the spill.
+  size_t high_water = 0;               ///< Largest used() seen at reset.
+  size_t spill_count = 0;              ///< Allocations that spilled.
+  std::pmr::monotonic_buffer_resource spill{
+      std::pmr::new_delete_resource()};  ///< Heap fallback for big frames.
+};
+
+#endif  // FRAME_ARENA_HPP
@@ -0,0 +1,96 @@
+/**
+ * @file FrameCache.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Per-frame tracking input shared by all tracks.
+ * @details The cache computes the conversions every track's tracker needs
+ * once per frame: a copy downscaled to the tracking resolution, and
+ * optionally its grayscale image. Trackers read the shared images and only
+ * do their track-specific work. Boxes are converted between frame and
+ * tracking coordinates with toTracking() and toFrame().
+ * @version 0.1
+ * @date 2024-11-25
+ */
+
+#ifndef FRAME_CACHE_HPP
+#define FRAME_CACHE_HPP
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct FrameCacheConfig
+ * @brief Resolution and image type of the tracking input.
+ */
+struct FrameCacheConfig {
+  double scale = 1.0;      ///< Tracking over frame resolution, in (0, 1].
+  bool grayscale = false;  ///< Track on the grayscale image.
+};
+
+/**
+ * @class FrameCache
+ * @brief Images derived from the current frame, computed once and read by
+ * every track.
+ * @details The images are owned by the cache and reused between frames, so
+ * after the first frame update() does not allocate. At scale 1 the scaled
+ * image shares the caller's frame without copying it. All images stay valid
+ * until the next update() and must not be modified.
+ */
+class FrameCache {
+ public:
+  /**
+   * @brief Constructor for the FrameCache class.
+   * @param config Tracking resolution and image.
+   * @throws std::invalid_argument if the scale is not in (0, 1].
+   */
+  explicit FrameCache(const FrameCacheConfig& config = FrameCacheConfig());
+
+  /**
+   * @brief Compute the images for a new frame.
+   * @param frame BGR or grayscale frame.
+   */
+  void update(const cv::Mat& frame);
+
+  /**
+   * @brief The frame at tracking resolution.
+   */
+  const cv::Mat& scaled() const { return scaledFrame; }
+
+  /**
+   * @brief Grayscale scaled frame; empty unless grayscale is configured.
+   */
+  const cv::Mat& gray() const { return grayFrame; }
+
+  /**
+   * @brief Image trackers run on: gray() or scaled().
+   */
+  const cv::Mat& trackingImage() const {
+    return config.grayscale ? grayFrame : scaledFrame;
+  }
+
+  /**
+   * @brief Map a box from frame to tracking coordinates.
+   * @param box Box in the frame.
+   * @return Box in trackingImage(), at least one pixel wide and high.
+   */
+  cv::Rect toTracking(const cv::Rect& box) const;
+
+  /**
+   * @brief Map a box from tracking to frame coordinates.
+   * @param box Box in trackingImage().
+   * @return Box in the frame.
+   */
+  cv::Rect toFrame(const cv::Rect& box) const;
+
+  /**
+   * @brief Configuration the cache was created with.
+   */
+  const FrameCacheConfig& getConfig() const { return config; }
+
+ private:
+  FrameCacheConfig config;  ///< Resolution and image type.
+  cv::Mat scaledFrame;      ///< Frame at tracking resolution.
+  cv::Mat grayFrame;        ///< Grayscale scaled frame.
+  double scaleX = 1.0;      ///< Tracking over frame width.
+  double scaleY = 1.0;      ///< Tracking over frame height.
+};
+
+#endif  // FRAME_CACHE_HPP
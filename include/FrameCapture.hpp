@@ -0,0 +1,139 @@
+/**
+ * @file FrameCapture.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the FrameCapture class, a capture thread that
+ * decodes into FramePool slots and hands them out through a ring buffer.
+ * @version 0.1
+ * @date 2024-11-08
+ */
+
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "FramePool.hpp"
+
+/**
+ * @enum CapturePolicy
+ * @brief What the capture thread does when the consumer falls behind.
+ */
+enum class CapturePolicy {
+  /// Wait for the consumer; every frame is delivered in order.
+  kEveryFrame,
+  /// Never wait; stale frames are dropped and next() returns the freshest.
+  kLatestFrame
+};
+
+/**
+ * @class FrameCapture
+ * @brief Runs frame acquisition on its own thread.
+ * @details The capture thread borrows a free pool slot, lets the grab
+ * function decode into it in place and pushes the handle into a fixed-size
+ * ring. Consumers pop handles with next() and pass them on without copying.
+ * When the ring is full the capture thread either waits, so every frame is
+ * delivered in order, or (CapturePolicy::kLatestFrame) drops the oldest
+ * queued frame so that a slow consumer always gets the newest one. Every
+ * frame is stamped with its sequence number and capture time.
+ */
+class FrameCapture {
+ public:
+  /**
+   * @brief Function that fills the given slot with the next frame.
+   * @details Return false at end of stream. For cv::VideoCapture use
+   * `[&cap](cv::Mat& frame) { return cap.read(frame); }`, which decodes into
+   * the existing buffer when size and type match.
+   */
+  using GrabFunction = std::function<bool(cv::Mat&)>;
+
+  /**
+   * @brief Constructor for the FrameCapture class.
+   * @param pool Pool providing the frame slots; must outlive the capture.
+   * @param grab Function decoding the next frame into a slot.
+   * @param depth Number of captured frames the ring can hold.
+   * @param policy Whether to wait for the consumer or drop stale frames.
+   */
+  FrameCapture(FramePool& pool, GrabFunction grab, size_t depth = 2,
+               CapturePolicy policy = CapturePolicy::kEveryFrame);
+
+  FrameCapture(const FrameCapture&) = delete;
+  FrameCapture& operator=(const FrameCapture&) = delete;
+
+  /**
+   * @brief Destructor; stops the capture thread.
+   */
+  ~FrameCapture();
+
+  /**
+   * @brief Functions run on the capture thread when it starts and right
+   * before it exits, e.g. to register it with a Scheduler. Set them before
+   * start(); either may be empty.
+   * @param onStart Called before the first grab.
+   * @param onExit Called after the last grab.
+   */
+  void setThreadHooks(std::function<void()> onStart,
+                      std::function<void()> onExit);
+
+  /**
+   * @brief Start the capture thread.
+   */
+  void start();
+
+  /**
+   * @brief Stop the capture thread and release all queued frames.
+   */
+  void stop();
+
+  /**
+   * @brief Take the next captured frame, waiting for one if necessary.
+   * @details With CapturePolicy::kLatestFrame, older queued frames are
+   * dropped and the newest one is returned.
+   * @return Handle to the frame, or an empty handle once the stream ended
+   * or the capture was stopped.
+   */
+  FrameHandle next();
+
+  size_t framesCaptured() const { return captured.load(); }  ///< Frames grabbed.
+
+  /**
+   * @brief Number of captured frames dropped as stale without being
+   * delivered (always zero with CapturePolicy::kEveryFrame).
+   */
+  size_t framesDropped() const { return dropped.load(); }
+
+ private:
+  /**
+   * @brief Body of the capture thread.
+   */
+  void captureLoop();
+
+  /**
+   * @brief Drop the oldest queued frame; the caller holds the mutex.
+   */
+  void dropOldest();
+
+  FramePool& pool;                  ///< Source of frame slots.
+  GrabFunction grab;                ///< Decodes into a slot.
+  std::function<void()> onStart;    ///< Capture thread start hook.
+  std::function<void()> onExit;     ///< Capture thread exit hook.
+  CapturePolicy policy;             ///< Behaviour when the ring is full.
+  std::vector<FrameHandle> ring;    ///< Fixed-size ring of captured frames.
+  size_t head = 0;                  ///< Index of the oldest queued frame.
+  size_t count = 0;                 ///< Number of queued frames.
+  std::mutex mutex;                 ///< Guards ring, head, count and flags.
+  std::condition_variable not_empty;  ///< Signalled when a frame is queued.
+  std::condition_variable not_full;   ///< Signalled when a frame is taken.
+  bool running = false;             ///< Whether the capture thread runs.
+  bool finished = false;            ///< Whether the stream has ended.
+  std::thread worker;               ///< Capture thread.
+  std::atomic<size_t> captured{0};  ///< Number of frames grabbed.
+  std::atomic<size_t> dropped{0};   ///< Number of stale frames dropped.
+};
+
+#endif  // FRAME_CAPTURE_HPP
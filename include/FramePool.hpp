@@ -0,0 +1,170 @@
+/**
+ * @file FramePool.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the FramePool class, a fixed set of preallocated
+ * frame buffers shared between pipeline stages through reference-counted
+ * handles.
+ * @details Frames are decoded straight into a free slot and handed from stage
+ * to stage as FrameHandle objects. Copying a handle only bumps the slot's
+ * reference count; the slot goes back to the free list when the last handle
+ * is dropped. Memory is bounded by the pool capacity and steady-state capture
+ * performs no allocation.
+ * @version 0.1
+ * @date 2024-11-08
+ */
+
+#ifndef FRAME_POOL_HPP
+#define FRAME_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+class FramePool;
+
+/**
+ * @class FrameHandle
+ * @brief Reference-counted borrow of one FramePool slot.
+ * @details An empty handle owns nothing. Handles must not outlive the pool
+ * they were acquired from.
+ */
+class FrameHandle {
+ public:
+  FrameHandle() = default;
+  FrameHandle(const FrameHandle& other);
+  FrameHandle(FrameHandle&& other) noexcept;
+  FrameHandle& operator=(const FrameHandle& other);
+  FrameHandle& operator=(FrameHandle&& other) noexcept;
+  ~FrameHandle();
+
+  /**
+   * @brief Image stored in the borrowed slot.
+   * @details Write into it in place (e.g. cv::VideoCapture::read) to keep the
+   * slot buffer; assigning a differently sized image reallocates it.
+   */
+  cv::Mat& mat() const;
+
+  /**
+   * @brief Record when and in which order the frame in this slot was
+   * captured.
+   * @param sequence Capture sequence number of the frame.
+   * @param time Time the frame was grabbed from the device.
+   */
+  void setCaptureInfo(uint64_t sequence,
+                      std::chrono::steady_clock::time_point time) const;
+
+  /**
+   * @brief Capture sequence number of the frame in this slot.
+   */
+  uint64_t sequence() const;
+
+  /**
+   * @brief Time the frame in this slot was grabbed from the device.
+   */
+  std::chrono::steady_clock::time_point captureTime() const;
+
+  /**
+   * @brief Index of the borrowed slot, or -1 for an empty handle.
+   */
+  int slot() const { return index; }
+
+  /**
+   * @brief Drop this reference, returning the slot if it was the last one.
+   */
+  void reset();
+
+  explicit operator bool() const { return pool != nullptr; }
+
+ private:
+  friend class FramePool;
+
+  FrameHandle(FramePool* pool, int index);
+
+  FramePool* pool = nullptr;  ///< Pool owning the slot, null when empty.
+  int index = -1;             ///< Slot index within the pool.
+};
+
+/**
+ * @class FramePool
+ * @brief Preallocated, bounded pool of frame buffers.
+ */
+class FramePool {
+ public:
+  /**
+   * @brief Constructor for the FramePool class.
+   * @param capacity Number of frame slots.
+   * @param size Frame size each slot is allocated with.
+   * @param type OpenCV element type of the slots, e.g. CV_8UC3.
+   */
+  FramePool(size_t capacity, const cv::Size& size, int type);
+
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  /**
+   * @brief Borrow a free slot, waiting until one is released.
+   * @param timeout Longest time to wait for a slot.
+   * @return A handle to the slot, or an empty handle on timeout.
+   */
+  FrameHandle acquire(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Borrow a free slot without waiting.
+   * @return A handle to the slot, or an empty handle if none is free.
+   */
+  FrameHandle tryAcquire();
+
+  /**
+   * @brief Deep-copy a frame into a newly borrowed slot.
+   * @details The only sanctioned way to copy pixels between stages; every
+   * call is counted by copies().
+   * @return Handle to the copy, or an empty handle if no slot is free.
+   */
+  FrameHandle copy(const FrameHandle& source);
+
+  size_t capacity() const { return slot_count; }  ///< Total slot count.
+
+  size_t available() const;  ///< Number of currently free slots.
+
+  /**
+   * @brief Number of times a slot buffer was reallocated after construction,
+   * detected when the slot is returned with a different data pointer.
+   */
+  size_t allocations() const { return allocation_count.load(); }
+
+  size_t copies() const { return copy_count.load(); }  ///< Calls to copy().
+
+ private:
+  friend class FrameHandle;
+
+  /**
+   * @struct Slot
+   * @brief One preallocated frame buffer and its reference count.
+   */
+  struct Slot {
+    cv::Mat mat;                  ///< Frame storage.
+    const uchar* buffer = nullptr;  ///< Data pointer the slot was issued with.
+    std::atomic<int> refs{0};     ///< Number of live handles.
+    uint64_t sequence = 0;        ///< Capture sequence number.
+    std::chrono::steady_clock::time_point captured;  ///< Capture time.
+  };
+
+  void retain(int index);
+  void release(int index);
+  FrameHandle take();
+
+  size_t slot_count;                ///< Number of slots.
+  std::unique_ptr<Slot[]> slots;    ///< Slot storage, never resized.
+  std::vector<int> free_slots;      ///< Stack of free slot indices.
+  mutable std::mutex mutex;         ///< Guards free_slots.
+  std::condition_variable slot_freed;  ///< Signalled when a slot returns.
+  std::atomic<size_t> allocation_count{0};  ///< Reallocated slot buffers.
+  std::atomic<size_t> copy_count{0};        ///< Deep copies made via copy().
+};
+
+#endif  // FRAME_POOL_HPP
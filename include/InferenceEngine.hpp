@@ -0,0 +1,172 @@
+/**
+ * @file InferenceEngine.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Inference backends behind YoloDetector.
+ * @details The detector prepares the input blob and decodes the output
+ * tensors; the forward pass in between goes through an InferenceEngine:
+ *          - OpenCvDnnEngine runs the Darknet network loaded by loadModel.
+ *          - SyntheticEngine emits YOLOv3-shaped outputs for a scripted scene
+ *            of moving people, with an optional simulated forward latency, so
+ *            decode, NMS, tracking and localization can be run and profiled
+ *            without the model weights.
+ * @version 0.1
+ * @date 2024-11-19
+ */
+
+#ifndef INFERENCE_ENGINE_HPP
+#define INFERENCE_ENGINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @class InferenceEngine
+ * @brief Runs the forward pass of a YOLO network.
+ */
+class InferenceEngine {
+ public:
+  virtual ~InferenceEngine() = default;
+
+  /**
+   * @brief Run the network on an input blob.
+   * @param blob NCHW input blob from cv::dnn::blobFromImage(s).
+   * @param outs Receives one matrix per YOLO output layer, with rows of
+   * (center x, center y, width, height, objectness, class scores...) in
+   * normalized coordinates. Batched inputs give [N, rows, cols] matrices or
+   * the items' rows stacked.
+   */
+  virtual void forward(const cv::Mat& blob, std::vector<cv::Mat>& outs) = 0;
+
+  /**
+   * @brief Short name of the backend, for reports.
+   */
+  virtual std::string name() const = 0;
+
+  /**
+   * @brief OpenCV network run by the engine, for layer profiling.
+   * @return The network, or nullptr if the engine runs none.
+   */
+  virtual cv::dnn::Net* network() { return nullptr; }
+};
+
+/**
+ * @class OpenCvDnnEngine
+ * @brief Forward pass through an OpenCV DNN network.
+ * @details Refers to the network owned by loadModel, so loadFromFile() may
+ * be called before or after the engine is created.
+ */
+class OpenCvDnnEngine : public InferenceEngine {
+ public:
+  /**
+   * @brief Constructor for the OpenCvDnnEngine class.
+   * @param net Network to run; must outlive the engine.
+   */
+  explicit OpenCvDnnEngine(cv::dnn::Net& net);
+
+  void forward(const cv::Mat& blob, std::vector<cv::Mat>& outs) override;
+
+  std::string name() const override { return "opencv-dnn"; }
+
+  cv::dnn::Net* network() override { return &net; }
+
+ private:
+  cv::dnn::Net& net;                  ///< Network owned by loadModel.
+  std::vector<std::string> outNames;  ///< Output layer names, looked up once.
+};
+
+/**
+ * @struct SyntheticSceneConfig
+ * @brief Scripted scene and output layout of the synthetic engine.
+ * @details Positions and sizes are in normalized frame coordinates. The
+ * default output layout is that of YOLOv3 at 416x416: three outputs of 507,
+ * 2028 and 8112 rows with 85 columns.
+ */
+struct SyntheticSceneConfig {
+  int people = 5;            ///< Number of people in the scene.
+  float speed = 0.004f;      ///< Largest per-frame step of a person.
+  float minHeight = 0.15f;   ///< Smallest person height.
+  float maxHeight = 0.45f;   ///< Largest person height.
+  float aspect = 0.4f;       ///< Width over height of a person box.
+  int rowsPerPerson = 3;     ///< Overlapping rows reporting each person.
+  float jitter = 0.003f;     ///< Noise on duplicate rows' coordinates.
+  float noiseObjectness = 0.05f;  ///< Largest objectness of empty rows.
+  std::vector<int> outputRows = {507, 2028, 8112};  ///< Rows per output.
+  int numClasses = 80;       ///< Class columns per row.
+  std::chrono::microseconds forwardLatency{0};  ///< Simulated forward time.
+  uint64_t seed = 1;         ///< Seed of the scene and the noise.
+};
+
+/**
+ * @class SyntheticEngine
+ * @brief Emits YOLO outputs for a scripted scene instead of running a
+ * network.
+ * @details Every forward() call emits the scene's current frame and then
+ * moves each person one step, bouncing off the frame edges. The input blob
+ * is ignored apart from its batch size; every batch item gets the same
+ * full-frame scene, so tiled detection is not meaningful with this engine.
+ * The output matrices are allocated once and reused.
+ */
+class SyntheticEngine : public InferenceEngine {
+ public:
+  /**
+   * @brief Constructor for the SyntheticEngine class.
+   * @param config Scene, output layout and simulated latency.
+   * @throws std::invalid_argument if the layout cannot hold the scene.
+   */
+  explicit SyntheticEngine(
+      const SyntheticSceneConfig& config = SyntheticSceneConfig());
+
+  void forward(const cv::Mat& blob, std::vector<cv::Mat>& outs) override;
+
+  std::string name() const override { return "synthetic"; }
+
+  /**
+   * @brief Boxes of the people the next forward() will emit.
+   * @param frameSize Size of the frame the boxes are mapped to.
+   */
+  std::vector<cv::Rect> groundTruth(const cv::Size& frameSize) const;
+
+  /**
+   * @brief Draw the people the next forward() will emit as textured boxes,
+   * so that trackers following them have something to lock on to.
+   * @param frame Frame to draw on.
+   */
+  void render(cv::Mat& frame) const;
+
+  /**
+   * @brief Number of frames emitted so far.
+   */
+  uint64_t framesEmitted() const { return frames; }
+
+ private:
+  /**
+   * @struct Person
+   * @brief One scripted person.
+   */
+  struct Person {
+    cv::Point2f center;    ///< Normalized box center.
+    cv::Point2f velocity;  ///< Normalized step per frame.
+    cv::Size2f size;       ///< Normalized box size.
+    float score;           ///< Person class score.
+  };
+
+  /**
+   * @brief Clear the rows written for the previous frame.
+   */
+  void clearPeople();
+
+  SyntheticSceneConfig config;     ///< Scene and layout.
+  cv::RNG rng;                     ///< Scene and noise generator.
+  std::vector<Person> people;      ///< Current scene.
+  std::vector<cv::Mat> outputs;    ///< Reused output matrices.
+  std::vector<std::pair<int, int>> written;  ///< (output, row) with people.
+  std::vector<std::vector<int>> rowOrder;    ///< Shuffled rows per output.
+  std::vector<int> nextRow;        ///< Next rowOrder entry per output.
+  int batch = 0;                   ///< Batch size outputs are sized for.
+  uint64_t frames = 0;             ///< Frames emitted.
+};
+
+#endif  // INFERENCE_ENGINE_HPP
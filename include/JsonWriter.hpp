@@ -0,0 +1,25 @@
+/**
+ * @file JsonWriter.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Helpers shared by the JSON exports of the tracing and profiling
+ * code.
+ * @version 0.1
+ * @date 2024-11-24
+ */
+
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Write a string as a JSON string literal.
+ * @details Quotes and backslashes are escaped; control characters become
+ * spaces.
+ * @param out Stream to write to.
+ * @param text String to write.
+ */
+void writeJsonString(std::ostream& out, const std::string& text);
+
+#endif  // JSON_WRITER_HPP
@@ -0,0 +1,70 @@
+/**
+ * @file LatencyStats.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the LatencyStats class that collects latency samples
+ * and reports percentiles.
+ * @version 0.1
+ * @date 2024-11-11
+ */
+
+#ifndef LATENCY_STATS_HPP
+#define LATENCY_STATS_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @class LatencyStats
+ * @brief Fixed-size window of latency samples with percentile reporting.
+ * @details Samples are kept in a preallocated ring holding the most recent
+ * `window` values, so recording is allocation-free and the report reflects
+ * recent behaviour rather than the whole run.
+ */
+class LatencyStats {
+ public:
+  /**
+   * @brief Constructor for the LatencyStats class.
+   * @param window Number of most recent samples kept for percentiles.
+   */
+  explicit LatencyStats(size_t window = 4096);
+
+  /**
+   * @brief Record one latency sample.
+   * @param latency Measured duration.
+   */
+  void record(std::chrono::steady_clock::duration latency);
+
+  /**
+   * @brief Record the time elapsed since a starting point, e.g. a frame's
+   * capture time.
+   * @param start Start of the measured interval.
+   */
+  void recordSince(std::chrono::steady_clock::time_point start);
+
+  /**
+   * @brief Latency percentile over the current window.
+   * @param percent Percentile in [0, 100].
+   * @return Latency in milliseconds, or 0 if nothing was recorded.
+   */
+  double percentile(double percent) const;
+
+  /**
+   * @brief Total number of samples recorded, including ones that have left
+   * the window.
+   */
+  size_t count() const { return total; }
+
+  /**
+   * @brief One-line summary with p50, p90, p99 and max in milliseconds.
+   * @param label Name printed in front of the figures.
+   */
+  std::string summary(const std::string& label) const;
+
+ private:
+  std::vector<double> samples;  ///< Ring of samples in milliseconds.
+  size_t next = 0;              ///< Ring slot the next sample goes to.
+  size_t total = 0;             ///< Number of samples ever recorded.
+};
+
+#endif  // LATENCY_STATS_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file LayerProfiler.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Per-layer forward time, FLOPs and memory of the loaded network.
+ * @details After each forward pass, collect() reads the per-layer timings
+ * of cv::dnn::Net::getPerfProfile and adds them up. The first pass at an
+ * input shape also records, for every layer, its type, FLOPs (getFLOPS) and
+ * weight and blob memory (getMemoryConsumption) at that shape. The result
+ * is reported per layer and per layer type, sorted by forward time, as a
+ * text table or JSON. Layers fused into their neighbour report zero time.
+ * @version 0.1
+ * @date 2024-11-24
+ */
+
+#ifndef LAYER_PROFILER_HPP
+#define LAYER_PROFILER_HPP
+
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @struct LayerCost
+ * @brief Cost of one network layer at the profiled input shape.
+ */
+struct LayerCost {
+  int id = 0;              ///< Layer id in the network.
+  std::string name;        ///< Layer name, e.g. "conv_12".
+  std::string type;        ///< Layer type, e.g. "Convolution".
+  int64_t flops = 0;       ///< Floating-point operations per forward pass.
+  size_t weightBytes = 0;  ///< Memory held by the layer's weights.
+  size_t blobBytes = 0;    ///< Memory of the layer's output blobs.
+  double totalMs = 0.0;    ///< Forward time summed over profiled frames.
+};
+
+/**
+ * @struct LayerTypeCost
+ * @brief Cost of all layers of one type.
+ */
+struct LayerTypeCost {
+  std::string type;        ///< Layer type.
+  int layers = 0;          ///< Number of layers of the type.
+  int64_t flops = 0;       ///< Summed FLOPs per forward pass.
+  size_t weightBytes = 0;  ///< Summed weight memory.
+  size_t blobBytes = 0;    ///< Summed output blob memory.
+  double totalMs = 0.0;    ///< Summed forward time over profiled frames.
+};
+
+/**
+ * @class LayerProfiler
+ * @brief Accumulates per-layer costs of a network over several frames.
+ */
+class LayerProfiler {
+ public:
+  /**
+   * @brief Constructor for the LayerProfiler class.
+   * @param maxFrames Frames to profile before collect() stops adding
+   * timings; 0 profiles every frame.
+   */
+  explicit LayerProfiler(size_t maxFrames = 0);
+
+  /**
+   * @brief Add the timings of the forward pass just run.
+   * @details A blob shape different from the profiled one restarts the
+   * profile at the new shape.
+   * @param net Network that ran the pass.
+   * @param blob Input blob of the pass.
+   * @return Whether the pass was added.
+   */
+  bool collect(cv::dnn::Net& net, const cv::Mat& blob);
+
+  /**
+   * @brief Start a new profile.
+   * @param inputShape Input shape the costs were measured at.
+   * @param layers Layers in the order of getPerfProfile's timings; their
+   * totalMs is kept as given.
+   */
+  void describe(const cv::dnn::MatShape& inputShape,
+                std::vector<LayerCost> layers);
+
+  /**
+   * @brief Add one frame's timings.
+   * @param layerMs Forward time in ms of each described layer, in order.
+   * @throws std::invalid_argument if the count differs from the layers.
+   */
+  void addFrame(const std::vector<double>& layerMs);
+
+  /**
+   * @brief Number of frames added since the profile started.
+   */
+  size_t frames() const { return frameCount; }
+
+  /**
+   * @brief Whether the frame limit has been reached.
+   */
+  bool done() const { return maxFrames > 0 && frameCount >= maxFrames; }
+
+  /**
+   * @brief Input shape of the profile, empty before the first frame.
+   */
+  const cv::dnn::MatShape& inputShape() const { return shape; }
+
+  /**
+   * @brief Layers, slowest first.
+   */
+  std::vector<LayerCost> byLayer() const;
+
+  /**
+   * @brief Layer types, slowest first.
+   */
+  std::vector<LayerTypeCost> byType() const;
+
+  /**
+   * @brief Forward time of all layers summed over the profiled frames.
+   */
+  double totalMs() const;
+
+  /**
+   * @brief Summary, the per-type table and the slowest layers as text.
+   * @param topLayers Number of layers listed; 0 lists all.
+   */
+  std::string textReport(size_t topLayers = 20) const;
+
+  /**
+   * @brief The complete profile as a JSON object. Times are per frame.
+   */
+  std::string jsonReport() const;
+
+  /**
+   * @brief Write jsonReport() to a file.
+   * @param path Output file.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void writeJson(const std::string& path) const;
+
+ private:
+  size_t maxFrames;               ///< Frame limit, 0 for none.
+  size_t frameCount = 0;          ///< Frames added.
+  cv::dnn::MatShape shape;        ///< Profiled input shape.
+  std::vector<LayerCost> layers;  ///< Layers in timing order.
+  std::vector<double> timings;    ///< Tick timings, reused.
+};
+
+#endif  // LAYER_PROFILER_HPP
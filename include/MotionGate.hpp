@@ -0,0 +1,96 @@
+/**
+ * @file MotionGate.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the MotionGate class that decides whether a frame
+ * needs a fresh detector pass.
+ * @details Fixed cameras often watch empty or unchanged scenes for minutes.
+ * The gate compares a small grayscale copy of each frame against the frame
+ * the detector last ran on and only asks for inference when enough pixels
+ * have changed, or when the forced refresh interval has elapsed.
+ * @version 0.1
+ * @date 2024-11-06
+ */
+
+#ifndef MOTION_GATE_HPP
+#define MOTION_GATE_HPP
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct MotionGateConfig
+ * @brief Tuning parameters for the motion gate.
+ */
+struct MotionGateConfig {
+  cv::Size analysisSize{160, 90};  ///< Size frames are downsampled to.
+  int pixelThreshold = 25;  ///< Grey-level difference that marks a change.
+
+  /**
+   * @brief Fraction of changed pixels above which the scene is considered to
+   * have moved.
+   */
+  double changedFraction = 0.002;
+
+  /**
+   * @brief Run the detector at least every this many frames even in a static
+   * scene. Zero or negative disables the forced refresh.
+   */
+  int refreshInterval = 30;
+};
+
+/**
+ * @class MotionGate
+ * @brief Cheap change detector run before inference.
+ * @details Each frame is area-downsampled, converted to grayscale and lightly
+ * blurred, then differenced against the reference frame with vectorized
+ * cv::absdiff and cv::threshold. The reference is replaced only when the
+ * detector runs, so slow drift still accumulates into a refresh.
+ */
+class MotionGate {
+ public:
+  /**
+   * @brief Constructor for the MotionGate class.
+   * @param config Downsampling, threshold and refresh parameters.
+   */
+  explicit MotionGate(const MotionGateConfig& config = MotionGateConfig());
+
+  /**
+   * @brief Decide whether the detector should run on this frame.
+   * @param frame Current BGR or grayscale frame.
+   * @return true if the scene changed, no reference exists yet or the forced
+   * refresh is due; false if the previous results can be reused.
+   */
+  bool shouldDetect(const cv::Mat& frame);
+
+  /**
+   * @brief Forget the reference frame so the next frame is always detected.
+   */
+  void reset();
+
+  /**
+   * @brief Fraction of frames seen so far for which detection was skipped.
+   */
+  double skipRate() const;
+
+  int framesSeen() const { return frames_seen; }  ///< Frames evaluated.
+
+  int framesSkipped() const { return frames_skipped; }  ///< Frames skipped.
+
+  /**
+   * @brief Fraction of changed pixels measured on the last frame.
+   */
+  double lastChangedFraction() const { return last_changed_fraction; }
+
+ private:
+  MotionGateConfig config;  ///< Gate parameters.
+  cv::Mat small;            ///< Downsampled frame, reused every call.
+  cv::Mat gray;             ///< Downsampled grayscale frame.
+  cv::Mat reference;        ///< Grayscale frame the detector last ran on.
+  cv::Mat diff;             ///< Per-pixel absolute difference.
+
+  int frames_seen = 0;           ///< Number of frames evaluated.
+  int frames_skipped = 0;        ///< Number of frames the gate skipped.
+  int frames_since_detect = 0;   ///< Frames since the detector last ran.
+  double last_changed_fraction = 0.0;  ///< Changed-pixel fraction measured.
+};
+
+#endif  // MOTION_GATE_HPP
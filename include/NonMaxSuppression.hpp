@@ -0,0 +1,32 @@
+/**
+ * @file NonMaxSuppression.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Greedy non-maximum suppression over caller-provided storage.
+ * @details Same result as cv::dnn::NMSBoxes without its internal temporary
+ * vectors: the scratch order and the kept indices live in the memory
+ * resource of the output vector, normally the per-frame arena.
+ * @version 0.1
+ * @date 2024-11-16
+ */
+
+#ifndef NON_MAX_SUPPRESSION_HPP
+#define NON_MAX_SUPPRESSION_HPP
+
+#include <memory_resource>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Keep the best-scoring boxes and drop boxes overlapping them.
+ * @param boxes Candidate boxes.
+ * @param scores Score of each candidate.
+ * @param scoreThreshold Candidates scoring at or below this are ignored.
+ * @param nmsThreshold IoU above which a box is suppressed by a better one.
+ * @param indices Receives indices of the kept boxes, best first; its memory
+ * resource also holds the scratch order.
+ */
+void nmsBoxes(const std::pmr::vector<cv::Rect>& boxes,
+              const std::pmr::vector<float>& scores, float scoreThreshold,
+              float nmsThreshold, std::pmr::vector<int>& indices);
+
+#endif  // NON_MAX_SUPPRESSION_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file ReplayHarness.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Record-and-replay of frame sequences for regression testing the
+ * tracking pipeline.
+ * @details A SequenceRecorder stores each frame losslessly together with the
+ * detections the tracker consumed for it. replaySequence() later feeds the
+ * recorded frames and detections through Tracker::updateTrackers, so the run
+ * is deterministic and needs no model weights. The resulting tracks can be
+ * compared with a golden file within a pixel tolerance, and the replay
+ * reports frames per second and per-stage latency.
+ *
+ * On-disk layout of a recorded sequence directory:
+ *          - frame_000000.png, frame_000001.png, ...
+ *          - detections.txt: one line per frame,
+ *            "<frame> <count> x y w h x y w h ..."
+ *
+ * Golden track files use one line per frame,
+ * "<frame> <count> id x y w h id x y w h ...".
+ * @version 0.1
+ * @date 2024-11-18
+ */
+
+#ifndef REPLAY_HARNESS_HPP
+#define REPLAY_HARNESS_HPP
+
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "LatencyStats.hpp"
+#include "Tracker.hpp"
+
+/**
+ * @struct TrackRecord
+ * @brief State of one track in one frame.
+ */
+struct TrackRecord {
+  int id;        ///< Track id.
+  cv::Rect box;  ///< Tracked box.
+};
+
+/// Tracks of one frame, ordered by id.
+using FrameTracks = std::vector<TrackRecord>;
+
+/**
+ * @class SequenceRecorder
+ * @brief Writes frames and their detector outputs to a sequence directory.
+ */
+class SequenceRecorder {
+ public:
+  /**
+   * @brief Constructor for the SequenceRecorder class.
+   * @param directory Output directory; created if missing.
+   * @throws std::runtime_error if the directory cannot be written.
+   */
+  explicit SequenceRecorder(const std::string& directory);
+
+  /**
+   * @brief Append one frame.
+   * @param frame Frame as it was before the tracker drew on it.
+   * @param detections Detections the tracker consumed for this frame.
+   */
+  void record(const cv::Mat& frame, const std::vector<cv::Rect>& detections);
+
+  /**
+   * @brief Number of frames written so far.
+   */
+  size_t framesRecorded() const { return frames; }
+
+ private:
+  std::string directory;    ///< Sequence directory.
+  std::ofstream detections;  ///< detections.txt, flushed per frame.
+  size_t frames = 0;        ///< Frames written.
+};
+
+/**
+ * @struct RecordedSequence
+ * @brief A recorded sequence loaded into memory.
+ */
+struct RecordedSequence {
+  std::vector<cv::Mat> frames;                    ///< Decoded frames.
+  std::vector<std::vector<cv::Rect>> detections;  ///< Detections per frame.
+
+  /**
+   * @brief Load a sequence directory written by SequenceRecorder.
+   * @param directory Sequence directory.
+   * @param decodeLatency Receives the PNG decode time of every frame.
+   * @throws std::runtime_error if the sequence is missing or malformed.
+   */
+  static RecordedSequence load(const std::string& directory,
+                               LatencyStats* decodeLatency = nullptr);
+};
+
+/**
+ * @struct ReplayReport
+ * @brief Outcome of a replay.
+ */
+struct ReplayReport {
+  size_t frames = 0;          ///< Frames replayed.
+  double fps = 0.0;           ///< Frames per second over the track stage.
+  LatencyStats trackLatency;  ///< Per-frame tracker update time.
+  std::vector<FrameTracks> tracks;  ///< Tracks after every frame.
+};
+
+/**
+ * @brief Feed a recorded sequence through a tracker.
+ * @param tracker Tracker to drive; it should have no live tracks.
+ * @param sequence Recorded frames and detections.
+ * @return Tracks per frame, frame rate and tracker latency.
+ * @details Frames are copied before the tracker draws on them, so the
+ * sequence can be replayed again.
+ */
+ReplayReport replaySequence(Tracker& tracker, const RecordedSequence& sequence);
+
+/**
+ * @brief Write tracks in the golden file format.
+ * @param path Output file.
+ * @param tracks Tracks per frame.
+ */
+void writeTracks(const std::string& path,
+                 const std::vector<FrameTracks>& tracks);
+
+/**
+ * @brief Read tracks in the golden file format.
+ * @param path Golden file.
+ * @return Tracks per frame.
+ * @throws std::runtime_error if the file is missing or malformed.
+ */
+std::vector<FrameTracks> readTracks(const std::string& path);
+
+/**
+ * @brief Compare tracks with golden tracks.
+ * @param actual Tracks produced by the replay.
+ * @param golden Expected tracks.
+ * @param tolerance Largest allowed difference of any box coordinate, in
+ * pixels.
+ * @return One message per mismatch; empty if the tracks agree.
+ */
+std::vector<std::string> compareTracks(const std::vector<FrameTracks>& actual,
+                                       const std::vector<FrameTracks>& golden,
+                                       int tolerance);
+
+#endif  // REPLAY_HARNESS_HPP
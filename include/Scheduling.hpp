@@ -0,0 +1,196 @@
+/**
+ * @file Scheduling.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Core budgets, thread affinity and CPU accounting per pipeline
+ * component.
+ * @details Each component (inference, tracking, capture, render) gets a set
+ * of cores. A thread announces which component it is working for with
+ * Scheduler::enter(); with pinning enabled the thread is then restricted to
+ * that component's cores, and its CPU time is charged to the component until
+ * it enters another one or leaves. The inference budget also caps OpenCV's
+ * worker pool (cv::setNumThreads), which otherwise uses every core for each
+ * forward pass. CPU time of threads that never registered, mainly OpenCV's
+ * parallel workers, is reported separately.
+ * @version 0.1
+ * @date 2024-11-20
+ */
+
+#ifndef SCHEDULING_HPP
+#define SCHEDULING_HPP
+
+#include <pthread.h>
+#include <time.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @enum Component
+ * @brief Pipeline components with their own core budget.
+ */
+enum class Component { kInference, kTracking, kCapture, kRender };
+
+/// Number of Component values.
+constexpr size_t kComponentCount = 4;
+
+/**
+ * @brief Lower-case name of a component, as used in schedule specs.
+ */
+const char* componentName(Component component);
+
+/**
+ * @struct SchedulingConfig
+ * @brief Core sets per component and the inference thread count.
+ */
+struct SchedulingConfig {
+  /**
+   * @brief Cores per component, indexed by Component. An empty set means no
+   * restriction.
+   */
+  std::array<std::vector<int>, kComponentCount> cores;
+
+  /**
+   * @brief OpenCV worker threads for inference; 0 keeps OpenCV's default.
+   * @details cv::setNumThreads is process-wide, so this also bounds any
+   * other OpenCV parallel region, e.g. inside the trackers.
+   */
+  int inferenceThreads = 0;
+
+  /**
+   * @brief Pin threads to their component's cores. Without pinning the core
+   * sets only serve as the budget utilization is reported against.
+   */
+  bool pin = false;
+
+  /**
+   * @brief Parse a schedule spec.
+   * @param spec Comma-separated entries `component=cores[@threads]`, where
+   * cores are ranges joined by '+', e.g.
+   * "inference=0-3@4,tracking=4,capture=5,render=5+6". A thread count is
+   * only accepted for inference.
+   * @return Parsed configuration, with pinning off.
+   * @throws std::invalid_argument on malformed specs.
+   */
+  static SchedulingConfig parse(const std::string& spec);
+};
+
+/**
+ * @struct ComponentUsage
+ * @brief CPU use of one component since the scheduler was created.
+ */
+struct ComponentUsage {
+  double cpuSeconds = 0.0;  ///< CPU time charged to the component.
+  double coresUsed = 0.0;   ///< cpuSeconds over elapsed wall time.
+  size_t coresBudgeted = 0;  ///< Size of the core set, 0 if unrestricted.
+};
+
+/**
+ * @class Scheduler
+ * @brief Applies a SchedulingConfig to the threads that register with it
+ * and accounts their CPU time per component.
+ * @details Use one scheduler per process. Register a thread before it makes
+ * its first OpenCV parallel call: OpenCV's worker threads inherit the
+ * affinity of the thread that creates them.
+ */
+class Scheduler {
+ public:
+  /**
+   * @brief Constructor for the Scheduler class.
+   * @param config Core budgets; applies inferenceThreads right away.
+   * @throws std::invalid_argument if a core is not available to the process.
+   */
+  explicit Scheduler(const SchedulingConfig& config = SchedulingConfig());
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  /**
+   * @brief Charge the calling thread's CPU time to a component from now on,
+   * pinning it to the component's cores if configured.
+   * @param component Component the thread now works for.
+   */
+  void enter(Component component);
+
+  /**
+   * @brief Stop accounting the calling thread, e.g. right before it exits.
+   */
+  void leave();
+
+  /**
+   * @brief CPU use per component.
+   */
+  std::array<ComponentUsage, kComponentCount> usage() const;
+
+  /**
+   * @brief CPU seconds of threads that never registered (mainly OpenCV's
+   * parallel workers, which do the bulk of a forward pass).
+   */
+  double unregisteredCpuSeconds() const;
+
+  /**
+   * @brief Multi-line utilization report.
+   */
+  std::string report() const;
+
+  /**
+   * @brief Configuration in use.
+   */
+  const SchedulingConfig& getConfig() const { return config; }
+
+ private:
+  /**
+   * @struct ThreadState
+   * @brief Accounting state of one registered thread.
+   */
+  struct ThreadState {
+    clockid_t clock;     ///< CPU-time clock of the thread.
+    int component = -1;  ///< Component being charged, -1 for none.
+    int64_t entered = 0;  ///< Thread CPU time at the last enter, in ns.
+    int pinned = -1;     ///< Component whose cores the thread is pinned to.
+  };
+
+  /**
+   * @brief Charge a thread's CPU time since its last enter; caller holds
+   * the mutex.
+   */
+  void charge(ThreadState& state, int64_t now);
+
+  /**
+   * @brief Registered state of the calling thread, creating it if needed;
+   * caller holds the mutex.
+   */
+  ThreadState& self();
+
+  /**
+   * @brief CPU time charged so far plus the time of live threads.
+   */
+  std::array<int64_t, kComponentCount> chargedNanos() const;
+
+  /**
+   * @brief Restrict the calling thread to the given cores; an empty set
+   * restores the cores the process started with.
+   */
+  void pinTo(const std::vector<int>& cores) const;
+
+  /// Source of the ids; a new scheduler may reuse a destroyed one's address.
+  static std::atomic<uint64_t> next_id;
+  static thread_local uint64_t current_owner;  ///< Id owning current_state.
+  static thread_local ThreadState* current_state;  ///< Calling thread state.
+
+  const uint64_t id;                   ///< Unique id of this scheduler.
+  SchedulingConfig config;             ///< Budgets and pinning.
+  std::vector<int> allowed_cores;      ///< Cores the process may run on.
+  std::chrono::steady_clock::time_point created;  ///< Start of accounting.
+  int64_t process_start = 0;           ///< Process CPU time at creation.
+  std::array<int64_t, kComponentCount> charged{};  ///< Ns per component.
+  std::list<ThreadState> threads;      ///< Registered live threads.
+  mutable std::mutex mutex;            ///< Guards charged and threads.
+};
+
+#endif  // SCHEDULING_HPP
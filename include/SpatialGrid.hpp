@@ -0,0 +1,174 @@
+/**
+ * @file SpatialGrid.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the SpatialGrid class, a uniform spatial hash over
+ * boxes used to find association candidates.
+ * @details Boxes are registered in every grid cell they touch; cells are
+ * hashed into a power-of-two bucket table, so the grid needs no bounds and
+ * its size only depends on the number of boxes. A query visits the boxes
+ * registered in the cells the query box touches, which for a cell size
+ * close to the typical box size are the handful of boxes nearby instead of
+ * all of them. Storage is kept between frames, so rebuilding the grid every
+ * frame does not allocate once it has grown to the scene.
+ * @version 0.1
+ * @date 2024-11-22
+ */
+
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @class SpatialGrid
+ * @brief Uniform spatial hash grid over integer-keyed boxes.
+ */
+class SpatialGrid {
+ public:
+  /**
+   * @brief Empty the grid and size it for a new set of boxes.
+   * @param cellSize Cell edge in pixels; about the size of a typical box.
+   * @param expected Number of boxes about to be inserted; sizes the bucket
+   * table.
+   */
+  void reset(int cellSize, size_t expected);
+
+  /**
+   * @brief Register a box under an id.
+   * @param id Non-negative id passed back by query(), e.g. a slot index.
+   * @param box Box in pixels; empty boxes are ignored.
+   */
+  void insert(int id, const cv::Rect& box);
+
+  /**
+   * @brief Visit the ids of all boxes sharing a cell with a query box.
+   * @details Candidates are not checked for overlap: a box sharing a cell
+   * may still miss the query box. Every id is visited at most once.
+   * @param box Query box.
+   * @param visit Called with each candidate id; return false to stop.
+   */
+  template <typename Visit>
+  void query(const cv::Rect& box, Visit&& visit);
+
+  /**
+   * @brief Find the detections that overlap no track and start a track for
+   * each; this is the association step of Tracker::updateTrackers.
+   * @details Rebuilds the grid from the tracks. Detections are taken in
+   * order, and each new track is inserted before the next detection is
+   * tested, so two overlapping new detections start a single track.
+   * @param tracks Number of track ids, 0 to tracks - 1; sizes the grid.
+   * @param boxOf Returns the box of a track id; an empty box for free ids.
+   * @param detections Detections of the frame.
+   * @param startTrack Called with each new detection; returns the id of the
+   * track started for it, whose box boxOf must then return.
+   * @return Number of tracks started.
+   */
+  template <typename BoxOf, typename StartTrack>
+  size_t associate(size_t tracks, BoxOf&& boxOf,
+                   const std::vector<cv::Rect>& detections,
+                   StartTrack&& startTrack);
+
+  int getCellSize() const { return cellSize; }  ///< Cell edge in pixels.
+
+  size_t size() const { return boxes; }  ///< Boxes inserted since reset.
+
+  /**
+   * @brief Cell size suited to a set of boxes: the mean of their larger
+   * sides, at least 16 pixels.
+   */
+  static int suggestCellSize(const std::vector<cv::Rect>& boxes);
+
+ private:
+  /**
+   * @struct Entry
+   * @brief One box registered in one cell.
+   */
+  struct Entry {
+    int id;    ///< Box id.
+    int cellX;  ///< Cell column.
+    int cellY;  ///< Cell row.
+    int next;  ///< Next entry in the same bucket, -1 at the end.
+  };
+
+  /**
+   * @brief Bucket index of a cell.
+   */
+  size_t bucket(int cellX, int cellY) const {
+    const uint32_t hash = static_cast<uint32_t>(cellX) * 73856093u ^
+                          static_cast<uint32_t>(cellY) * 19349663u;
+    return hash & (heads.size() - 1);
+  }
+
+  /**
+   * @brief Cell column or row of a pixel coordinate.
+   */
+  int cellOf(int coordinate) const {
+    return coordinate >= 0 ? coordinate / cellSize
+                           : -((-coordinate - 1) / cellSize) - 1;
+  }
+
+  int cellSize = 64;            ///< Cell edge in pixels.
+  size_t boxes = 0;             ///< Boxes inserted since reset.
+  std::vector<int> heads;       ///< First entry per bucket, -1 if none.
+  std::vector<Entry> entries;   ///< Registered (box, cell) pairs.
+  std::vector<uint32_t> seen;   ///< Query stamp per id, for de-duplication.
+  uint32_t stamp = 0;           ///< Stamp of the running query.
+};
+
+template <typename Visit>
+void SpatialGrid::query(const cv::Rect& box, Visit&& visit) {
+  if (box.empty() || entries.empty()) {
+    return;
+  }
+  if (++stamp == 0) {
+    std::fill(seen.begin(), seen.end(), 0);
+    stamp = 1;
+  }
+  const int firstX = cellOf(box.x);
+  const int lastX = cellOf(box.x + box.width - 1);
+  const int firstY = cellOf(box.y);
+  const int lastY = cellOf(box.y + box.height - 1);
+  for (int cellY = firstY; cellY <= lastY; ++cellY) {
+    for (int cellX = firstX; cellX <= lastX; ++cellX) {
+      for (int e = heads[bucket(cellX, cellY)]; e >= 0; e = entries[e].next) {
+        const Entry& entry = entries[e];
+        if (entry.cellX != cellX || entry.cellY != cellY ||
+            seen[entry.id] == stamp) {
+          continue;
+        }
+        seen[entry.id] = stamp;
+        if (!visit(entry.id)) {
+          return;
+        }
+      }
+    }
+  }
+}
+
+template <typename BoxOf, typename StartTrack>
+size_t SpatialGrid::associate(size_t tracks, BoxOf&& boxOf,
+                              const std::vector<cv::Rect>& detections,
+                              StartTrack&& startTrack) {
+  reset(suggestCellSize(detections), tracks + detections.size());
+  for (size_t i = 0; i < tracks; ++i) {
+    insert(static_cast<int>(i), boxOf(static_cast<int>(i)));
+  }
+  size_t started = 0;
+  for (const auto& det : detections) {
+    bool isNew = true;
+    query(det, [&](int id) {
+      isNew = (det & boxOf(id)).area() == 0;
+      return isNew;
+    });
+    if (isNew) {
+      insert(startTrack(det), det);
+      ++started;
+    }
+  }
+  return started;
+}
+
+#endif  // SPATIAL_GRID_HPP
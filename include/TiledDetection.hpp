@@ -0,0 +1,92 @@
+/**
+ * @file TiledDetection.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Tile layout and cross-tile merging for high-resolution detection.
+ * @details Downscaling a 1280x720 or 4K frame to the 416x416 network input
+ * makes distant people too small to detect. Tiled detection instead splits
+ * the frame into overlapping tiles at native resolution, runs every tile in a
+ * single batched forward pass and merges the per-tile boxes back into frame
+ * coordinates.
+ * @version 0.1
+ * @date 2024-11-04
+ */
+
+#ifndef TILED_DETECTION_HPP
+#define TILED_DETECTION_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @struct TilingConfig
+ * @brief Tile layout and merge parameters for tiled detection.
+ */
+struct TilingConfig {
+  int tileWidth = 416;   ///< Tile width in frame pixels.
+  int tileHeight = 416;  ///< Tile height in frame pixels.
+  int overlap = 96;      ///< Pixels shared by neighbouring tiles.
+
+  /**
+   * @brief Also run the downscaled full frame as an extra batch item so that
+   * people larger than a tile are still found.
+   */
+  bool includeFullFrame = true;
+
+  float confidenceThreshold = 0.5f;  ///< Minimum class score to keep a box.
+  float scoreThreshold = 0.7f;       ///< Score threshold applied at merge.
+  float nmsThreshold = 0.4f;         ///< IoU above which boxes are duplicates.
+
+  /**
+   * @brief Intersection over the smaller box above which a box cut at a tile
+   * seam is merged into its counterpart from the neighbouring tile.
+   */
+  float seamMergeThreshold = 0.5f;
+
+  /**
+   * @brief Distance in pixels from an interior tile edge within which a box
+   * is treated as cut by that edge.
+   */
+  int seamMargin = 4;
+};
+
+/**
+ * @struct TileDetection
+ * @brief A detection in frame coordinates together with the tile it came
+ * from.
+ */
+struct TileDetection {
+  cv::Rect box;       ///< Bounding box in frame coordinates.
+  float confidence;   ///< Class score of the detection.
+  cv::Rect tile;      ///< Tile (in frame coordinates) that produced the box.
+};
+
+/**
+ * @brief Compute the overlapping tile grid covering a frame.
+ * @param frameSize Size of the full frame.
+ * @param config Tile size and overlap.
+ * @return Tile rectangles in frame coordinates, row-major. The last row and
+ * column are aligned to the frame border so every pixel is covered.
+ * @throws std::invalid_argument if the overlap is not smaller than the tile.
+ */
+std::vector<cv::Rect> computeTiles(const cv::Size& frameSize,
+                                   const TilingConfig& config);
+
+/**
+ * @brief Merge detections gathered from several tiles.
+ * @param detections Per-tile detections in frame coordinates.
+ * @param frameSize Size of the full frame, used to tell interior tile edges
+ * from the frame border.
+ * @param config Score, NMS and seam merge thresholds.
+ * @return Final bounding boxes after cross-tile NMS.
+ * @details Boxes are visited in descending score order. A lower-scored box is
+ * suppressed when its IoU with a kept box exceeds the NMS threshold. When
+ * either box is cut by an interior tile edge and the two come from different
+ * tiles, the pair is instead compared by intersection over the smaller area
+ * and, above the seam threshold, merged into their union so that a person
+ * split across a seam is reported once with a full box.
+ */
+std::vector<cv::Rect> mergeTileDetections(
+    const std::vector<TileDetection>& detections, const cv::Size& frameSize,
+    const TilingConfig& config);
+
+#endif  // TILED_DETECTION_HPP
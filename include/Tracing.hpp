@@ -0,0 +1,141 @@
+/**
+ * @file Tracing.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Per-frame pipeline tracing exported as Chrome trace-event JSON.
+ * @details Stages are instrumented with TraceScope, which records the
+ * scope's begin and end time on the calling thread. Each thread appends to
+ * its own fixed-size ring, which keeps its latest events: the owner is the
+ * only writer and publishes each event with one atomic store, so recording
+ * takes no lock and never allocates. Tracing is off by default and
+ * switched at runtime with Tracing::setEnabled(); while it is off a
+ * TraceScope costs one relaxed atomic load. Tracing::writeChromeTrace()
+ * dumps all threads' events as a JSON file that chrome://tracing and
+ * https://ui.perfetto.dev open directly, one track per thread.
+ * @version 0.1
+ * @date 2024-11-23
+ */
+
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class Tracing
+ * @brief Process-wide trace switch, thread buffers and export.
+ */
+class Tracing {
+ public:
+  /// Events each thread holds; newer events overwrite the oldest.
+  static constexpr size_t kEventsPerThread = 1 << 16;
+
+  /// Value of TraceScope's argument when it has none.
+  static constexpr int64_t kNoArgument = INT64_MIN;
+
+  /**
+   * @brief Whether scopes are being recorded.
+   */
+  static bool enabled() {
+    return active.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Start or stop recording. Scopes already open when tracing stops
+   * are still recorded.
+   */
+  static void setEnabled(bool on);
+
+  /**
+   * @brief Name the calling thread in the exported trace, e.g. "capture".
+   * @param name Thread name; copied.
+   */
+  static void setThreadName(const std::string& name);
+
+  /**
+   * @brief Record one completed scope on the calling thread.
+   * @param name Stage name; must be a string literal or otherwise outlive
+   * the export.
+   * @param begin Begin time from now().
+   * @param end End time from now().
+   * @param argument Frame number, track id or similar, or kNoArgument.
+   */
+  static void record(const char* name, int64_t begin, int64_t end,
+                     int64_t argument);
+
+  /**
+   * @brief Monotonic time in nanoseconds, as stored in events.
+   */
+  static int64_t now();
+
+  /**
+   * @brief Write every recorded event as Chrome trace-event JSON.
+   * @details Safe to call while other threads keep recording; events they
+   * publish during the export may or may not be included.
+   * @param path Output file.
+   * @return Number of events written.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  static size_t writeChromeTrace(const std::string& path);
+
+  /**
+   * @brief Number of events held, over all threads; at most
+   * kEventsPerThread per thread.
+   */
+  static size_t eventCount();
+
+  /**
+   * @brief Events lost because newer ones overwrote them.
+   */
+  static size_t droppedCount();
+
+  /**
+   * @brief Discard all recorded events. Only call while tracing is off and
+   * no scope is open.
+   */
+  static void clear();
+
+ private:
+  static std::atomic<bool> active;  ///< Whether scopes are recorded.
+};
+
+/**
+ * @class TraceScope
+ * @brief Records the lifetime of a block as one trace event.
+ * @details Usage: `TraceScope scope("forward");` at the top of the block,
+ * or `TraceScope scope("track update", trackId);` to attach a number.
+ * Whether the scope is recorded is decided when it opens.
+ */
+class TraceScope {
+ public:
+  /**
+   * @brief Open the scope.
+   * @param name Stage name; must be a string literal.
+   * @param argument Number shown with the event, e.g. a frame or track id.
+   */
+  explicit TraceScope(const char* name,
+                      int64_t argument = Tracing::kNoArgument)
+      : name(Tracing::enabled() ? name : nullptr),
+        argument(argument),
+        begin(this->name ? Tracing::now() : 0) {}
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  /**
+   * @brief Close the scope and record it.
+   */
+  ~TraceScope() {
+    if (name) {
+      Tracing::record(name, begin, Tracing::now(), argument);
+    }
+  }
+
+ private:
+  const char* name;  ///< Stage name, null if not recorded.
+  int64_t argument;  ///< Attached number.
+  int64_t begin;     ///< Begin time in ns.
+};
+
+#endif  // TRACING_HPP
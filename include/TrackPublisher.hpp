@@ -0,0 +1,92 @@
+/**
+ * @file TrackPublisher.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the TrackPublisher class, which writes each
+ * frame's tracks into a shared-memory ring for consumers on the robot.
+ * @details See TrackRing.hpp for the layout and the reader side. The
+ * publisher is the single writer of the ring. It never waits for readers,
+ * and a frame is written straight into its ring slot, so publishing costs
+ * one pass over the live tracks.
+ * @version 0.1
+ * @date 2024-11-21
+ */
+
+#ifndef TRACK_PUBLISHER_HPP
+#define TRACK_PUBLISHER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "TrackRing.hpp"
+#include "Tracker.hpp"
+
+/**
+ * @class TrackPublisher
+ * @brief Creates a track ring in POSIX shared memory and publishes to it.
+ * @details Must be used from one thread. The shared-memory object is
+ * removed when the publisher is destroyed; subscribers that still have it
+ * mapped keep reading the last frames.
+ */
+class TrackPublisher {
+ public:
+  /**
+   * @brief Constructor for the TrackPublisher class.
+   * @param name Shared-memory object name, e.g. "/perception_tracks". An
+   * existing object of that name is replaced.
+   * @param slots Ring length; a subscriber that falls further behind loses
+   * frames.
+   * @throws std::invalid_argument if slots is below 2.
+   * @throws std::runtime_error if the object cannot be created.
+   */
+  explicit TrackPublisher(const std::string& name, size_t slots = 16);
+
+  TrackPublisher(const TrackPublisher&) = delete;
+  TrackPublisher& operator=(const TrackPublisher&) = delete;
+
+  /**
+   * @brief Destructor; unmaps and removes the ring.
+   */
+  ~TrackPublisher();
+
+  /**
+   * @brief Publish the live tracks of a tracker with their estimated
+   * positions.
+   * @param tracker Tracker after its Track call for the frame.
+   * @param captured Capture time of the frame, if known.
+   */
+  void publish(Tracker& tracker,
+               std::chrono::steady_clock::time_point captured = {});
+
+  /**
+   * @brief Start writing the next frame in place.
+   * @details Fill count, tracks and optionally captured, then call commit().
+   * Readers skip the slot until then.
+   * @return The frame in its ring slot, with frame set.
+   */
+  TrackFrame& beginFrame();
+
+  /**
+   * @brief Stamp and release the frame begun with beginFrame().
+   */
+  void commit();
+
+  /**
+   * @brief Number of frames published.
+   */
+  uint64_t framesPublished() const { return next; }
+
+  /**
+   * @brief Shared-memory object name.
+   */
+  const std::string& getName() const { return name; }
+
+ private:
+  std::string name;                 ///< Shared-memory object name.
+  TrackRingHeader* header = nullptr;  ///< Mapped ring.
+  TrackRingSlot* ring = nullptr;    ///< First slot.
+  size_t bytes = 0;                 ///< Mapped size.
+  uint64_t next = 0;                ///< Sequence number of the next frame.
+};
+
+#endif  // TRACK_PUBLISHER_HPP
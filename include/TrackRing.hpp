@@ -0,0 +1,198 @@
+/**
+ * @file TrackRing.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Shared-memory layout of the per-frame track ring and the reader
+ * side of it.
+ * @details TrackPublisher writes one TrackFrame per processed frame into a
+ * ring of slots in a POSIX shared-memory object. Any number of consumer
+ * processes map the object read-only through TrackSubscriber. There is no
+ * lock: every slot carries a sequence counter that is odd while the
+ * publisher writes the slot (a seqlock), so a reader copies the slot and
+ * retries if the counter changed meanwhile. The publisher never waits for
+ * readers; a reader that falls more than a ring length behind loses frames
+ * and is told how many.
+ *
+ * This header only depends on the standard library and POSIX, so
+ * consumers link the small track_reader library and not OpenCV.
+ * @version 0.1
+ * @date 2024-11-21
+ */
+
+#ifndef TRACK_RING_HPP
+#define TRACK_RING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Largest number of tracks a TrackFrame carries.
+constexpr size_t kMaxSharedTracks = 64;
+
+/**
+ * @struct SharedTrack
+ * @brief One track as published to consumers.
+ */
+struct SharedTrack {
+  int32_t id;        ///< Track id, stable while the track lives.
+  int32_t x;         ///< Box left edge in pixels.
+  int32_t y;         ///< Box top edge in pixels.
+  int32_t width;     ///< Box width in pixels.
+  int32_t height;    ///< Box height in pixels.
+  float position[3];  ///< Estimated (x, y, z) in the robot frame.
+};
+
+/**
+ * @struct TrackFrame
+ * @brief Tracks of one processed frame.
+ */
+struct TrackFrame {
+  uint64_t frame;      ///< Publish sequence number, starting at 0.
+  int64_t published;   ///< sharedClockNanos() when the frame was published.
+  int64_t captured;    ///< sharedClockNanos() of capture, 0 if unknown.
+  uint32_t count;      ///< Number of valid entries in tracks.
+  uint32_t truncated;  ///< Tracks left out because the frame was full.
+  SharedTrack tracks[kMaxSharedTracks];  ///< Live tracks.
+};
+
+/**
+ * @struct TrackRingSlot
+ * @brief One ring slot: a seqlock counter and the frame it guards.
+ */
+struct alignas(64) TrackRingSlot {
+  std::atomic<uint64_t> sequence;  ///< Odd while being written.
+  TrackFrame frame;                ///< Slot payload.
+};
+
+/**
+ * @struct TrackRingHeader
+ * @brief Start of the shared-memory object; the slots follow it.
+ */
+struct alignas(64) TrackRingHeader {
+  std::atomic<uint32_t> magic;  ///< kTrackRingMagic once initialised.
+  uint32_t layout;              ///< kTrackRingLayout of the publisher.
+  uint32_t slots;               ///< Number of slots.
+  uint32_t slotSize;            ///< sizeof(TrackRingSlot) of the publisher.
+  std::atomic<uint64_t> published;  ///< Frames published so far.
+};
+
+/// Marks an initialised ring.
+constexpr uint32_t kTrackRingMagic = 0x54524b52;  // "TRKR"
+/// Bumped whenever TrackFrame or the ring layout changes.
+constexpr uint32_t kTrackRingLayout = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The track ring needs lock-free 64-bit atomics");
+
+/**
+ * @brief Clock shared by all processes on the machine (CLOCK_MONOTONIC),
+ * used for the timestamps in TrackFrame.
+ * @return Nanoseconds.
+ */
+int64_t sharedClockNanos();
+
+/**
+ * @brief Convert a steady_clock time point to sharedClockNanos() time.
+ * @details On Linux steady_clock is CLOCK_MONOTONIC, so this is exact.
+ */
+int64_t toSharedClock(std::chrono::steady_clock::time_point time);
+
+/**
+ * @brief Bytes of a shared-memory object holding a ring of the given size.
+ */
+size_t trackRingBytes(size_t slots);
+
+/**
+ * @enum ReadStatus
+ * @brief Outcome of TrackSubscriber::next().
+ */
+enum class ReadStatus {
+  kFrame,    ///< A frame was read.
+  kNoFrame,  ///< Nothing new has been published.
+  kLost,     ///< Frames were overwritten unread; a frame was still read.
+  kStalled   ///< The next frame stayed half-written; nothing was read.
+};
+
+/**
+ * @class TrackSubscriber
+ * @brief Read-only consumer of a track ring.
+ * @details Maps the ring read-only, so any number of subscribers may run.
+ * Each read copies one slot into the caller's TrackFrame and is retried if
+ * the publisher overwrote the slot during the copy. A subscriber must be
+ * used from one thread at a time.
+ */
+class TrackSubscriber {
+ public:
+  /**
+   * @brief Constructor for the TrackSubscriber class.
+   * @param name Shared-memory object name, e.g. "/perception_tracks".
+   * @throws std::runtime_error if the ring does not exist, is not
+   * initialised or has an incompatible layout.
+   */
+  explicit TrackSubscriber(const std::string& name);
+
+  TrackSubscriber(const TrackSubscriber&) = delete;
+  TrackSubscriber& operator=(const TrackSubscriber&) = delete;
+
+  /**
+   * @brief Destructor; unmaps the ring.
+   */
+  ~TrackSubscriber();
+
+  /**
+   * @brief Read the newest published frame.
+   * @param frame Receives the frame.
+   * @return False if nothing has been published yet or the newest frame
+   * stayed half-written.
+   */
+  bool latest(TrackFrame& frame);
+
+  /**
+   * @brief Read the frame after the last one this subscriber read.
+   * @details Starts at the frame that is newest when the subscriber is
+   * created. If the wanted frame has been overwritten, reading skips to the
+   * oldest frame still in the ring and the skipped frames are counted in
+   * framesLost(). A frame the publisher left half-written, e.g. because it
+   * died mid-write, gives kStalled until a newer frame is published; it is
+   * then skipped and counted as lost.
+   * @param frame Receives the frame.
+   * @return Whether a frame was read and whether frames were lost before it.
+   */
+  ReadStatus next(TrackFrame& frame);
+
+  /**
+   * @brief Like next(), but waits for a frame, spinning briefly and then
+   * yielding. A stalled publisher is waited for like an idle one.
+   * @param frame Receives the frame.
+   * @param timeout Longest wait.
+   * @return False on timeout.
+   */
+  bool waitNext(TrackFrame& frame, std::chrono::microseconds timeout);
+
+  /**
+   * @brief Frames overwritten before this subscriber read them.
+   */
+  uint64_t framesLost() const { return lost; }
+
+  /**
+   * @brief Number of slots in the ring.
+   */
+  size_t slots() const { return header->slots; }
+
+ private:
+  /**
+   * @brief Copy the frame with the given sequence number.
+   * @return kFrame on success, kLost if it was overwritten before or during
+   * the copy, kStalled if it stayed half-written.
+   */
+  ReadStatus read(uint64_t number, TrackFrame& frame) const;
+
+  const TrackRingHeader* header = nullptr;  ///< Mapped ring.
+  const TrackRingSlot* ring = nullptr;      ///< First slot.
+  size_t bytes = 0;                         ///< Mapped size.
+  uint64_t wanted = 0;                      ///< Next frame to read.
+  uint64_t lost = 0;                        ///< Frames lost so far.
+};
+
+#endif  // TRACK_RING_HPP
@@ -18,8 +18,25 @@
 #include <string>
 #include <vector>
 
+#include "FrameArena.hpp"
+#include "FrameCache.hpp"
+#include "MotionGate.hpp"
+#include "Scheduling.hpp"
+#include "SpatialGrid.hpp"
 #include "detectHuman.hpp"
 
+/**
+ * @struct TrackSlot
+ * @brief One pooled track; its OpenCV tracker is created once and
+ * re-initialized for every new person assigned to the slot.
+ */
+struct TrackSlot {
+  cv::Ptr<cv::Tracker> tracker;  ///< KCF tracker owned by the slot
+  cv::Rect box;                  ///< Frame box from the last update
+  int id = -1;                   ///< Track id, unique while the tracker lives
+  bool active = false;           ///< Whether the slot holds a live track
+};
+
 /**
  * @class Tracker
  * @brief A class for detecting and tracking humans in images/video frames
@@ -44,15 +61,85 @@ class Tracker : public detectHuman {
    * @param image Current frame to process
    * @details Detects humans in the current frame and updates existing trackers.
    *          Draws bounding boxes and position information on the image.
+   *          With motion gating enabled, the detector is skipped on static
+   *          frames and the previous detections are reused.
    */
   void Track(const cv::Mat& image);
 
+  /**
+   * @brief Track slots, live and free; check TrackSlot::active.
+   */
+  const std::vector<TrackSlot>& getTrackSlots() const { return slots; }
+
+  /**
+   * @brief Number of live tracks.
+   */
+  size_t activeTrackCount() const;
+
+  /**
+   * @brief Per-frame arena used by Track, e.g. to check its high-water mark.
+   */
+  const FrameArena& getFrameArena() const { return trackArena; }
+
+  /**
+   * @brief Run the motion gate before every detector pass.
+   * @param config Gate parameters, including the forced refresh interval.
+   */
+  void enableMotionGating(const MotionGateConfig& config = MotionGateConfig());
+
+  /**
+   * @brief Motion gate used by Track, e.g. to report its skip rate.
+   */
+  const MotionGate& getMotionGate() const { return motionGate; }
+
+  /**
+   * @brief Whether Track draws boxes and positions onto the frame (the
+   * default). Turn it off when overlays are rendered elsewhere, e.g. by a
+   * VideoSink on its own thread.
+   */
+  void setDrawOverlays(bool draw) { drawOverlays = draw; }
+
+  /**
+   * @brief Choose the image the per-track trackers run on, e.g. a half-size
+   * grayscale copy of the frame. Boxes are still reported in frame
+   * coordinates.
+   * @param config Tracking resolution and image.
+   * @details Live tracks were initialized on the old tracking image, so they
+   * are dropped; detection starts new ones on the next frame.
+   * @throws std::invalid_argument if the scale is not in (0, 1].
+   */
+  void setFrameCache(const FrameCacheConfig& config);
+
+  /**
+   * @brief Tracking images of the last frame.
+   */
+  const FrameCache& getFrameCache() const { return frameCache; }
+
+  /**
+   * @brief Charge Track's detection to the inference budget and its tracker
+   * updates to the tracking budget of a Scheduler.
+   * @param scheduler Scheduler to report to, or nullptr to stop; must
+   * outlive its use by Track.
+   */
+  void setScheduler(Scheduler* scheduler) { this->scheduler = scheduler; }
+
+  /**
+   * @brief Detections used by the last Track call, e.g. to return them from
+   * an AsyncDetector wrapped around Track.
+   */
+  const std::vector<cv::Rect>& getDetections() const { return lastDetections; }
+
   /**
    * @brief Update tracking status for all tracked humans
    * @param detections Vector of detected human bounding boxes
    * @param Image Current frame being processed
-   * @details Updates existing trackers, removes failed ones, and initializes
-   *          new trackers for newly detected humans.
+   * @details Updates every live track once, frees the slots of failed ones,
+   *          and assigns free slots to newly detected humans. Detections
+   *          are matched against the live tracks through a spatial grid,
+   *          so association time grows linearly with the crowd. No heap
+   *          allocation happens unless the slot pool or the grid has to
+   *          grow. All trackers read the same FrameCache images, which
+   *          are computed once per frame.
    */
   void updateTrackers(const std::vector<cv::Rect>& detections,
                       const cv::Mat& Image);
@@ -72,8 +159,32 @@ class Tracker : public detectHuman {
   float radians_to_degrees(float radians);
 
  private:
-  std::vector<cv::Ptr<cv::Tracker>>
-      trackers;  ///< Vector of OpenCV trackers for multiple humans
+  /**
+   * @brief Take a free slot, growing the pool if all are live. Only
+   * updateTrackers frees slots; it resets the search hint.
+   */
+  TrackSlot& acquireSlot();
+
+  /**
+   * @brief Draw the box and estimated position of a track.
+   */
+  void drawTrack(const TrackSlot& slot, const cv::Mat& Image);
+
+  std::vector<TrackSlot> slots;  ///< Pool of track slots
+  int next_track_id = 0;         ///< Id given to the next new track
+  size_t free_slot_hint = 0;     ///< First slot acquireSlot may find free
+  FrameArena trackArena;         ///< Transient per-frame data, reset by Track
+  std::string overlayText;       ///< Reused label buffer for drawTrack
+  bool drawOverlays = true;      ///< Whether updateTrackers calls drawTrack
+  SpatialGrid trackGrid;         ///< Live track boxes, rebuilt every frame
+  FrameCache frameCache;         ///< Tracking images shared by all tracks
+
+  Scheduler* scheduler = nullptr;  ///< Optional per-component accounting
+
+  bool motionGating = false;  ///< Whether Track consults the motion gate
+  MotionGate motionGate;      ///< Change detector run before inference
+  std::vector<cv::Rect>
+      lastDetections;  ///< Detections reused while the scene is static
 };
 
 #endif  // TRACKER_HPP
\ No newline at end of file
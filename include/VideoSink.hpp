@@ -0,0 +1,172 @@
+/**
+ * @file VideoSink.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the VideoSink class, which renders track overlays
+ * and encodes annotated frames to a video file on its own thread.
+ * @details The control loop hands over a frame and its tracks with
+ * submit(), which only copies the pixels into one of the sink's own
+ * preallocated buffers and queues it. Drawing the overlays and encoding
+ * with cv::VideoWriter happen on the writer thread. The queue is bounded:
+ * when it is full the sink drops a frame rather than make the caller wait,
+ * so a slow disk or encoder never slows detection. Frames can be thinned
+ * to every Nth one, or to those with people in them, before they are
+ * copied.
+ * @version 0.1
+ * @date 2024-11-22
+ */
+
+#ifndef VIDEO_SINK_HPP
+#define VIDEO_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FramePool.hpp"
+#include "Tracker.hpp"
+
+/**
+ * @struct AnnotatedTrack
+ * @brief A track as drawn on the written video.
+ */
+struct AnnotatedTrack {
+  int id;                ///< Track id.
+  cv::Rect box;          ///< Box in pixels.
+  cv::Point3f position;  ///< Estimated position in the robot frame.
+};
+
+/**
+ * @brief Collect the live tracks of a tracker with their positions.
+ * @param tracker Tracker after its Track call for the frame.
+ * @param tracks Replaced with the tracks; a vector reused across frames
+ * keeps its capacity, so steady state does not allocate.
+ */
+void annotatedTracks(Tracker& tracker, std::vector<AnnotatedTrack>& tracks);
+
+/**
+ * @enum SinkDropPolicy
+ * @brief Which frame a full VideoSink queue gives up.
+ */
+enum class SinkDropPolicy {
+  /// Drop the oldest queued frame; the video stays close to live.
+  kDropOldest,
+  /// Drop the submitted frame; the queued backlog is written unbroken.
+  kDropNewest
+};
+
+/**
+ * @struct VideoSinkConfig
+ * @brief Output file, encoder, queue and frame selection of a VideoSink.
+ */
+struct VideoSinkConfig {
+  std::string path;   ///< Output video file.
+  double fps = 30.0;  ///< Frame rate written into the file.
+  int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');  ///< Codec.
+  size_t queueDepth = 8;  ///< Frames waiting for the encoder at most.
+  SinkDropPolicy dropPolicy = SinkDropPolicy::kDropOldest;  ///< When full.
+  size_t everyNth = 1;          ///< Keep one of every N submitted frames.
+  bool onlyWithPeople = false;  ///< Skip frames without tracks.
+  bool drawOverlays = true;     ///< Draw boxes and positions of the tracks.
+};
+
+/**
+ * @class VideoSink
+ * @brief Bounded, non-blocking writer of annotated video.
+ * @details submit() must be called from one thread. The video file is
+ * opened with the size and type of the first kept frame. Later frames of
+ * another size are resized to it as they are copied; frames of another
+ * type are dropped.
+ */
+class VideoSink {
+ public:
+  /**
+   * @brief Constructor for the VideoSink class; starts the writer thread.
+   * @param config Output file, encoder, queue and frame selection.
+   * @throws std::invalid_argument if path is empty or queueDepth or
+   * everyNth is zero.
+   */
+  explicit VideoSink(const VideoSinkConfig& config);
+
+  VideoSink(const VideoSink&) = delete;
+  VideoSink& operator=(const VideoSink&) = delete;
+
+  /**
+   * @brief Destructor; writes the queued frames and closes the file.
+   */
+  ~VideoSink();
+
+  /**
+   * @brief Queue a frame for writing, unless it is filtered out.
+   * @param frame Frame without overlays (with drawOverlays) or already
+   * annotated; its pixels are copied, so the caller may reuse it at once.
+   * @param tracks Tracks of the frame; copied into a track buffer of the
+   * sink that is reused once its frame is encoded.
+   * @return True if the frame was queued; false if filtered, dropped
+   * (kDropNewest or another type) or the sink failed.
+   */
+  bool submit(const cv::Mat& frame, const std::vector<AnnotatedTrack>& tracks);
+
+  /**
+   * @brief Write the queued frames, stop the writer thread and close the
+   * file. Later submissions are ignored.
+   */
+  void close();
+
+  uint64_t framesWritten() const { return written.load(); }  ///< Encoded.
+  /// Dropped on a full queue or for having another type.
+  uint64_t framesDropped() const { return dropped.load(); }
+  uint64_t framesFiltered() const { return filtered.load(); }  ///< Skipped.
+
+  /**
+   * @brief Whether the video file could not be opened; the sink then
+   * discards every frame.
+   */
+  bool failed() const { return openFailed.load(); }
+
+ private:
+  /**
+   * @struct Item
+   * @brief A queued frame.
+   */
+  struct Item {
+    FrameHandle frame;                  ///< Copy of the submitted pixels.
+    std::vector<AnnotatedTrack> tracks;  ///< Tracks to draw.
+  };
+
+  /**
+   * @brief Body of the writer thread.
+   */
+  void run();
+
+  /**
+   * @brief Draw the tracks onto a queued frame.
+   */
+  void drawOverlays(cv::Mat& frame, const std::vector<AnnotatedTrack>& tracks);
+
+  VideoSinkConfig config;           ///< Output and selection settings.
+  std::unique_ptr<FramePool> pool;  ///< Frame copies, created on first use.
+  std::deque<Item> queue;           ///< Frames waiting for the encoder.
+  /// Track buffers of encoded or dropped frames, reused by submit().
+  std::vector<std::vector<AnnotatedTrack>> spareTracks;
+  std::mutex mutex;  ///< Guards queue, spareTracks and stopping.
+  std::condition_variable wake;     ///< Signals queued frames and stopping.
+  bool stopping = false;            ///< Set by close().
+  uint64_t submitted = 0;           ///< Calls to submit(), for everyNth.
+  cv::VideoWriter writer;           ///< Encoder, used by the writer thread.
+  cv::Size videoSize;               ///< Size the file was opened with.
+  std::string overlayText;          ///< Reused label buffer.
+  std::thread worker;               ///< Writer thread.
+  std::atomic<uint64_t> written{0};   ///< Frames encoded.
+  std::atomic<uint64_t> dropped{0};   ///< Frames dropped (framesDropped()).
+  std::atomic<uint64_t> filtered{0};  ///< Frames skipped by the selection.
+  std::atomic<bool> openFailed{false};  ///< The file could not be opened.
+};
+
+#endif  // VIDEO_SINK_HPP
@@ -0,0 +1,195 @@
+/**
+ * @file YoloDetector.hpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Header file for the YoloDetector class template, the single YOLO
+ * detection implementation behind detectHuman and Detector.
+ * @details The detector is parameterized by compile-time policies (see
+ * DetectorPolicies.hpp) and runs its forward pass through an InferenceEngine
+ * (see InferenceEngine.hpp): the loaded Darknet network by default, or e.g. a
+ * SyntheticEngine when no weights are available. Two instantiations are compiled into
+ * perception_task:
+ *          - PersonDetector: person-only, compile-time thresholds; the decode
+ *            loop reads one class column and never scans or compares names.
+ *          - GenericDetector: runtime class set and thresholds.
+ *          Further combinations need an explicit instantiation in
+ *          libs/YoloDetector.cpp.
+ * @version 0.1
+ * @date 2024-11-13
+ */
+
+#ifndef YOLO_DETECTOR_HPP
+#define YOLO_DETECTOR_HPP
+
+#include <memory>
+#include <memory_resource>
+#include <opencv2/opencv.hpp>
+#include <opencv2/tracking.hpp>
+#include <string>
+#include <vector>
+
+#include "DetectorPolicies.hpp"
+#include "FrameArena.hpp"
+#include "InferenceEngine.hpp"
+#include "LayerProfiler.hpp"
+#include "TiledDetection.hpp"
+#include "loadModel.hpp"
+
+/**
+ * @class YoloDetector
+ * @brief YOLO detector assembled from compile-time policies.
+ * @tparam ClassFilter Which classes are kept.
+ * @tparam BoxLayout How the box is encoded in an output row.
+ * @tparam ScoreMode How objectness and class score combine.
+ * @tparam Thresholds Confidence, score and NMS thresholds.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+class YoloDetector : public loadModel {
+ public:
+  /**
+   * @brief Constructor for the YoloDetector class.
+   * @param modelPath Path to the pre-trained model file.
+   * @param configPath Path to the model configuration file.
+   * @param classesPath Path to the file containing class names.
+   * @param filter Class filter; runtime filters carry their class set.
+   * @param thresholds Thresholds; runtime thresholds carry their values.
+   */
+  YoloDetector(const std::string& modelPath, const std::string& configPath,
+               const std::string& classesPath,
+               ClassFilter filter = ClassFilter(),
+               Thresholds thresholds = Thresholds());
+
+  /**
+   * @brief Replace the inference backend.
+   * @param engine Engine used by all later forward passes.
+   */
+  void setEngine(std::shared_ptr<InferenceEngine> engine);
+
+  /**
+   * @brief Current inference backend.
+   */
+  InferenceEngine& getEngine() const { return *engine; }
+
+  /**
+   * @brief Profile the network's layers on the following forward passes.
+   * @param frames Passes to profile; 0 profiles all of them.
+   * @return The profiler, owned by the detector; replaces any earlier one.
+   * @details Only passes through an engine that runs an OpenCV network
+   * (InferenceEngine::network()) are profiled.
+   */
+  LayerProfiler& profileLayers(size_t frames = 0);
+
+  /**
+   * @brief Layer profiler set by profileLayers(), or nullptr.
+   */
+  const LayerProfiler* getLayerProfiler() const { return layerProfiler.get(); }
+
+  /**
+   * @brief Detect objects of the filtered classes in an image.
+   * @param Image The image frame to process.
+   * @return Bounding boxes after non-maximum suppression.
+   */
+  std::vector<cv::Rect> detect(const cv::Mat& Image);
+
+  /**
+   * @brief Detect into per-frame storage.
+   * @param Image The image frame to process.
+   * @param arena Per-frame arena holding the result and all scratch data.
+   * @return Bounding boxes after non-maximum suppression, allocated in the
+   * arena and valid until its next reset.
+   * @details The input blob and output tensors are reused between calls, so
+   * after the first frame only the forward pass itself allocates.
+   */
+  std::pmr::vector<cv::Rect> detect(const cv::Mat& Image, FrameArena& arena);
+
+  /**
+   * @brief Turn network outputs into detections: decode, then NMS.
+   * @param outs Outputs of the forward pass.
+   * @param frameSize Size of the frame the input blob was made from.
+   * @param arena Per-frame arena holding the result and all scratch data.
+   * @return Bounding boxes after non-maximum suppression, allocated in the
+   * arena.
+   * @details Performs no heap allocation once boxes and confidences have
+   * reached their working capacity.
+   */
+  std::pmr::vector<cv::Rect> postprocess(const std::vector<cv::Mat>& outs,
+                                         const cv::Size& frameSize,
+                                         FrameArena& arena);
+
+  /**
+   * @brief Detect on overlapping native-resolution tiles.
+   * @param Image The image frame to process.
+   * @param config Tile layout and merge thresholds.
+   * @return Bounding boxes in frame coordinates after cross-tile NMS.
+   * @details All tiles (and optionally the downscaled full frame) are packed
+   * into one blob and run in a single batched forward pass, so distant
+   * people keep their native pixel size instead of shrinking to the network
+   * input.
+   */
+  std::vector<cv::Rect> detectTiled(
+      const cv::Mat& Image, const TilingConfig& config = TilingConfig());
+
+  /**
+   * @brief Decode detections from one YOLO output matrix.
+   * @param out Output rows of (box, objectness, class scores...).
+   * @param region Area of the frame the network input was taken from; the
+   * normalized box coordinates are mapped into it.
+   * @param threshold Minimum score for a row to be kept.
+   * @param outBoxes Decoded boxes in frame coordinates are appended here.
+   * @param outConfidences Matching scores are appended here.
+   * @details Class scores never exceed objectness, so rows whose objectness
+   * is already below the threshold are rejected before the class filter
+   * runs. The class filter must be bound (see bindClasses()).
+   */
+  void decode(const cv::Mat& out, const cv::Rect& region, float threshold,
+              std::pmr::vector<cv::Rect>& outBoxes,
+              std::pmr::vector<float>& outConfidences) const;
+
+  /**
+   * @brief Resolve class names of a runtime class filter against the loaded
+   * labels. Called by detect() when needed.
+   */
+  void bindClasses();
+
+  /**
+   * @brief Vector of bounding boxes decoded from the last frame, before NMS.
+   * @details Copied out of the arena; its capacity is kept between frames.
+   */
+  std::vector<cv::Rect> boxes;
+
+  /**
+   * @brief Vector of scores corresponding to each decoded box.
+   */
+  std::vector<float> confidences;
+
+ protected:
+  ClassFilter filter;     ///< Class filter policy.
+  Thresholds thresholds;  ///< Threshold policy.
+  FrameArena frameArena;  ///< Arena for calls without a caller arena.
+
+ private:
+  std::shared_ptr<InferenceEngine> engine;  ///< Forward pass backend.
+  cv::Mat blob;               ///< Input blob, reused between frames.
+  std::vector<cv::Mat> outs;  ///< Output tensors, reused.
+  std::unique_ptr<LayerProfiler> layerProfiler;  ///< Set by profileLayers().
+
+  /**
+   * @brief Hand the last forward pass to the layer profiler, if any.
+   */
+  void collectLayerTimings();
+};
+
+/// Person-only detector with the tracker's compile-time thresholds.
+using PersonDetector = YoloDetector<PersonOnly, CenterSizeBoxes, ClassScore,
+                                    PersonThresholds>;
+
+/// Detector whose classes and thresholds are configured at runtime.
+using GenericDetector = YoloDetector<ClassSet, CenterSizeBoxes, ClassScore,
+                                     RuntimeThresholds>;
+
+extern template class YoloDetector<PersonOnly, CenterSizeBoxes, ClassScore,
+                                   PersonThresholds>;
+extern template class YoloDetector<ClassSet, CenterSizeBoxes, ClassScore,
+                                   RuntimeThresholds>;
+
+#endif  // YOLO_DETECTOR_HPP
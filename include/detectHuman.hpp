@@ -14,18 +14,20 @@
 #include <string>
 #include <vector>
 
-#include "loadModel.hpp"
+#include "TiledDetection.hpp"
+#include "YoloDetector.hpp"
 
 /**
  * @class detectHuman
  * @brief Class for detecting humans in images using a pre-trained model.
  *
- * The detectHuman class is derived from the loadModel class and is responsible
- * for performing human detection on a given image. It provides methods to load
- * a model, detect humans, and store the results as bounding boxes and
- * confidence scores.
+ * The detectHuman class is the person-only instantiation of YoloDetector
+ * (PersonDetector) and is responsible for performing human detection on a
+ * given image. Its decode loop is specialized at compile time: it reads the
+ * person score column directly, with no class scan and no class-name
+ * comparison, and uses the tracker's fixed thresholds.
  */
-class detectHuman : public loadModel {
+class detectHuman : public PersonDetector {
  public:
   /**
    * @brief Constructor for the detectHuman class.
@@ -44,14 +46,22 @@ class detectHuman : public loadModel {
   std::vector<cv::Rect> detectHumans(const cv::Mat& Image);
 
   /**
-   * @brief Vector of bounding boxes for detected humans.
+   * @brief Detect humans into per-frame storage.
+   * @param Image The image frame in which to detect humans.
+   * @param arena Per-frame arena that holds the result until its reset.
+   * @return Bounding rectangles allocated in the arena.
    */
-  std::vector<cv::Rect> boxes;
+  std::pmr::vector<cv::Rect> detectHumans(const cv::Mat& Image,
+                                          FrameArena& arena);
 
   /**
-   * @brief Vector of confidence scores corresponding to each detected human.
+   * @brief Detect humans on overlapping native-resolution tiles.
+   * @param Image The image frame in which to detect humans.
+   * @param config Tile layout and merge thresholds.
+   * @return Bounding rectangles in frame coordinates after cross-tile NMS.
    */
-  std::vector<float> confidences;
+  std::vector<cv::Rect> detectHumansTiled(
+      const cv::Mat& Image, const TilingConfig& config = TilingConfig());
 };
 
 #endif  // DETECT_HUMAN_HPP
@@ -0,0 +1,258 @@
+/**
+ * @file AsyncDetector.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the AsyncDetector class.
+ * @version 0.1
+ * @date 2024-11-15
+ */
+
+#include "AsyncDetector.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Constructor for the AsyncDetector class.
+ * @param detect Detection function run on the executor thread.
+ * @param config In-flight and age limits.
+ */
+AsyncDetector::AsyncDetector(DetectFunction detect,
+                             const AsyncDetectorConfig& config)
+    : detect(std::move(detect)), config(config) {
+  if (config.maxInFlight == 0) {
+    throw std::invalid_argument("AsyncDetector needs maxInFlight >= 1");
+  }
+  executor = std::thread(&AsyncDetector::run, this);
+}
+
+AsyncDetector::~AsyncDetector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (executor.joinable()) {
+    executor.join();
+  }
+  cancelPending();
+}
+
+/**
+ * @brief Submits a frame and returns a future for its result.
+ * @param frame Frame to process; its pixels are shared, not copied.
+ * @return Future of the result.
+ */
+std::future<DetectionResult> AsyncDetector::submit(const cv::Mat& frame) {
+  Request request;
+  request.frame = frame;
+  request.promise = std::make_shared<std::promise<DetectionResult>>();
+  std::future<DetectionResult> result = request.promise->get_future();
+  enqueue(std::move(request));
+  return result;
+}
+
+/**
+ * @brief Submits a pooled frame and returns a future for its result.
+ * @param frame Frame to process; the handle is held until completion.
+ * @return Future of the result.
+ */
+std::future<DetectionResult> AsyncDetector::submit(const FrameHandle& frame) {
+  Request request;
+  request.frame = frame.mat();
+  request.handle = frame;
+  request.promise = std::make_shared<std::promise<DetectionResult>>();
+  std::future<DetectionResult> result = request.promise->get_future();
+  enqueue(std::move(request));
+  return result;
+}
+
+/**
+ * @brief Submits a frame with a completion callback.
+ * @param frame Frame to process; its pixels are shared, not copied.
+ * @param onComplete Callback receiving the result.
+ * @return Id of the request.
+ */
+uint64_t AsyncDetector::submit(const cv::Mat& frame, Callback onComplete) {
+  Request request;
+  request.frame = frame;
+  request.onComplete = std::move(onComplete);
+  return enqueue(std::move(request));
+}
+
+/**
+ * @brief Submits a pooled frame with a completion callback.
+ * @param frame Frame to process; the handle is held until completion.
+ * @param onComplete Callback receiving the result.
+ * @return Id of the request.
+ */
+uint64_t AsyncDetector::submit(const FrameHandle& frame, Callback onComplete) {
+  Request request;
+  request.frame = frame.mat();
+  request.handle = frame;
+  request.onComplete = std::move(onComplete);
+  return enqueue(std::move(request));
+}
+
+/**
+ * @brief Cancels every queued request.
+ * @return Number of cancelled requests.
+ */
+size_t AsyncDetector::cancelPending() {
+  std::deque<Request> stale;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stale.swap(queue);
+    cancelled += stale.size();
+  }
+  for (auto& request : stale) {
+    cancel(request);
+  }
+  return stale.size();
+}
+
+size_t AsyncDetector::inFlight() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.size() + (busy ? 1 : 0);
+}
+
+size_t AsyncDetector::completedCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return completed;
+}
+
+size_t AsyncDetector::cancelledCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return cancelled;
+}
+
+/**
+ * @brief Queues a request, making room under the in-flight bound.
+ *
+ * When the bound is reached the oldest queued request is cancelled, since a
+ * newer frame makes its result stale. If nothing is queued (the bound is one
+ * and a request is running) the new request is cancelled instead; a running
+ * forward pass is never interrupted. Cancellations are delivered after the
+ * lock is released so callbacks may resubmit.
+ *
+ * @param request Request to queue.
+ * @return Id assigned to the request.
+ */
+uint64_t AsyncDetector::enqueue(Request request) {
+  request.result.submitted = std::chrono::steady_clock::now();
+
+  Request evicted;
+  bool evict = false;
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    id = next_id++;
+    request.result.requestId = id;
+    if (stopping) {
+      evicted = std::move(request);
+      evict = true;
+    } else if (queue.size() + (busy ? 1 : 0) >= config.maxInFlight) {
+      if (queue.empty()) {
+        evicted = std::move(request);
+      } else {
+        evicted = std::move(queue.front());
+        queue.pop_front();
+        queue.push_back(std::move(request));
+      }
+      evict = true;
+    } else {
+      queue.push_back(std::move(request));
+    }
+    if (evict) {
+      ++cancelled;
+    }
+  }
+
+  if (evict) {
+    cancel(evicted);
+  } else {
+    wake.notify_one();
+  }
+  return id;
+}
+
+/**
+ * @brief Delivers a finished or cancelled request.
+ * @param request Request whose result is complete.
+ */
+void AsyncDetector::finish(Request& request) {
+  request.result.completed = std::chrono::steady_clock::now();
+  // Release the frame before the consumer sees the result, so a pooled slot
+  // is already free when the control loop reacts
+  request.frame.release();
+  request.handle.reset();
+  if (request.promise) {
+    if (request.result.error) {
+      request.promise->set_exception(request.result.error);
+    } else {
+      request.promise->set_value(std::move(request.result));
+    }
+  } else if (request.onComplete) {
+    request.onComplete(request.result);
+  }
+}
+
+/**
+ * @brief Marks a request cancelled and delivers it.
+ * @param request Request that will not be run.
+ */
+void AsyncDetector::cancel(Request& request) {
+  request.result.cancelled = true;
+  request.result.detections.clear();
+  finish(request);
+}
+
+/**
+ * @brief Body of the executor thread.
+ *
+ * Takes the oldest queued request, cancels it if it has aged past the limit
+ * and otherwise runs the detection function on it outside the lock.
+ */
+void AsyncDetector::run() {
+  if (config.threadStart) {
+    config.threadStart();
+  }
+  while (true) {
+    Request request;
+    bool stale = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping) {
+        break;
+      }
+      request = std::move(queue.front());
+      queue.pop_front();
+      stale = config.maxAge.count() > 0 &&
+              std::chrono::steady_clock::now() - request.result.submitted >
+                  config.maxAge;
+      busy = true;
+    }
+
+    if (stale) {
+      cancel(request);
+    } else {
+      try {
+        request.result.detections = detect(request.frame);
+      } catch (...) {
+        request.result.error = std::current_exception();
+      }
+      finish(request);
+    }
+
+    // Only after delivery, so a caller seeing inFlight() == 0 finds every
+    // future ready
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busy = false;
+      ++(stale ? cancelled : completed);
+    }
+  }
+  if (config.threadExit) {
+    config.threadExit();
+  }
+}
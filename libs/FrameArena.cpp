@@ -0,0 +1,61 @@
+/**
+ * @file FrameArena.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the FrameArena class.
+ * @version 0.1
+ * @date 2024-11-16
+ */
+
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for the FrameArena class.
+ * @param capacity Initial block size in bytes.
+ */
+FrameArena::FrameArena(size_t capacity)
+    : block(new std::byte[capacity]), block_size(capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("FrameArena capacity must be positive");
+  }
+}
+
+/**
+ * @brief Releases the frame's allocations, growing the block if the frame
+ * did not fit.
+ */
+void FrameArena::reset() {
+  high_water = std::max(high_water, used());
+  if (spilled > 0) {
+    spill.release();
+    // Headroom for alignment padding and growing containers
+    block_size = std::max(block_size * 2, high_water + high_water / 2);
+    block.reset(new std::byte[block_size]);
+  }
+  offset = 0;
+  spilled = 0;
+}
+
+/**
+ * @brief Bumps the offset past an aligned allocation, or spills to the heap
+ * when the block is full.
+ * @param bytes Requested size.
+ * @param alignment Requested alignment, a power of two.
+ * @return Pointer to the allocation.
+ */
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+  const auto base = reinterpret_cast<std::uintptr_t>(block.get());
+  const std::uintptr_t start =
+      (base + offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+  const size_t end = static_cast<size_t>(start - base) + bytes;
+  if (end <= block_size) {
+    offset = end;
+    return reinterpret_cast<void*>(start);
+  }
+  ++spill_count;
+  spilled += bytes + alignment;
+  return spill.allocate(bytes, alignment);
+}
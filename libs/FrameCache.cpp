@@ -0,0 +1,83 @@
+/**
+ * @file FrameCache.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the FrameCache class.
+ * @version 0.1
+ * @date 2024-11-25
+ */
+
+#include "FrameCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Scales a pixel coordinate or length, rounding to the nearest pixel.
+ */
+int rescale(int value, double factor) {
+  return static_cast<int>(std::lround(value * factor));
+}
+
+}  // namespace
+
+/**
+ * @brief Constructor for the FrameCache class.
+ * @param config Tracking resolution and image.
+ */
+FrameCache::FrameCache(const FrameCacheConfig& config) : config(config) {
+  if (!(config.scale > 0.0 && config.scale <= 1.0)) {
+    throw std::invalid_argument("Tracking scale must be in (0, 1]");
+  }
+}
+
+/**
+ * @brief Downscales the frame and converts it to grayscale if configured.
+ * @param frame Current BGR or grayscale frame.
+ */
+void FrameCache::update(const cv::Mat& frame) {
+  if (config.scale < 1.0) {
+    cv::resize(frame, scaledFrame, cv::Size(), config.scale, config.scale,
+               cv::INTER_AREA);
+  } else {
+    scaledFrame = frame;
+  }
+  // The exact ratios of the rounded size, so boxes map back without drift
+  if (frame.cols > 0 && frame.rows > 0) {
+    scaleX = static_cast<double>(scaledFrame.cols) / frame.cols;
+    scaleY = static_cast<double>(scaledFrame.rows) / frame.rows;
+  }
+
+  if (!config.grayscale) {
+    return;
+  }
+  if (scaledFrame.channels() == 1) {
+    grayFrame = scaledFrame;
+  } else {
+    cv::cvtColor(scaledFrame, grayFrame, cv::COLOR_BGR2GRAY);
+  }
+}
+
+/**
+ * @brief Scales a frame box to the tracking resolution.
+ * @param box Box in frame coordinates.
+ * @return Box in tracking coordinates.
+ */
+cv::Rect FrameCache::toTracking(const cv::Rect& box) const {
+  return cv::Rect(rescale(box.x, scaleX), rescale(box.y, scaleY),
+                  std::max(1, rescale(box.width, scaleX)),
+                  std::max(1, rescale(box.height, scaleY)));
+}
+
+/**
+ * @brief Scales a tracking box back to the frame resolution.
+ * @param box Box in tracking coordinates.
+ * @return Box in frame coordinates.
+ */
+cv::Rect FrameCache::toFrame(const cv::Rect& box) const {
+  return cv::Rect(rescale(box.x, 1.0 / scaleX), rescale(box.y, 1.0 / scaleY),
+                  rescale(box.width, 1.0 / scaleX),
+                  rescale(box.height, 1.0 / scaleY));
+}
@@ -0,0 +1,184 @@
+/**
+ * @file FrameCapture.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the FrameCapture class.
+ * @version 0.1
+ * @date 2024-11-08
+ */
+
+#include "FrameCapture.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "Tracing.hpp"
+
+/**
+ * @brief Constructor for the FrameCapture class.
+ * @param pool Pool providing the frame slots.
+ * @param grab Function decoding the next frame into a slot.
+ * @param depth Number of captured frames the ring can hold.
+ * @param policy Whether to wait for the consumer or drop stale frames.
+ */
+FrameCapture::FrameCapture(FramePool& pool, GrabFunction grab, size_t depth,
+                           CapturePolicy policy)
+    : pool(pool), grab(std::move(grab)), policy(policy), ring(depth) {
+  if (depth == 0) {
+    throw std::invalid_argument("FrameCapture ring depth must be positive");
+  }
+}
+
+FrameCapture::~FrameCapture() { stop(); }
+
+/**
+ * @brief Sets the functions run on the capture thread at start and exit.
+ * @param onStart Called before the first grab.
+ * @param onExit Called after the last grab.
+ */
+void FrameCapture::setThreadHooks(std::function<void()> onStart,
+                                  std::function<void()> onExit) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (running) {
+    throw std::logic_error("Thread hooks must be set before start()");
+  }
+  this->onStart = std::move(onStart);
+  this->onExit = std::move(onExit);
+}
+
+/**
+ * @brief Starts the capture thread.
+ */
+void FrameCapture::start() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (running) {
+    return;
+  }
+  running = true;
+  finished = false;
+  worker = std::thread(&FrameCapture::captureLoop, this);
+}
+
+/**
+ * @brief Stops the capture thread and returns all queued slots to the pool.
+ */
+void FrameCapture::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+  }
+  not_full.notify_all();
+  not_empty.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& frame : ring) {
+    frame.reset();
+  }
+  head = 0;
+  count = 0;
+}
+
+/**
+ * @brief Takes the oldest captured frame, waiting for one if necessary.
+ * @return Handle to the frame, or an empty handle at end of stream.
+ */
+FrameHandle FrameCapture::next() {
+  std::unique_lock<std::mutex> lock(mutex);
+  not_empty.wait(lock, [this] { return count > 0 || finished || !running; });
+  if (count == 0) {
+    return FrameHandle();
+  }
+  if (policy == CapturePolicy::kLatestFrame) {
+    while (count > 1) {
+      dropOldest();
+    }
+  }
+  FrameHandle frame = std::move(ring[head]);
+  head = (head + 1) % ring.size();
+  --count;
+  lock.unlock();
+  not_full.notify_one();
+  return frame;
+}
+
+/**
+ * @brief Drops the oldest queued frame, returning its slot to the pool.
+ */
+void FrameCapture::dropOldest() {
+  ring[head].reset();
+  head = (head + 1) % ring.size();
+  --count;
+  ++dropped;
+}
+
+/**
+ * @brief Body of the capture thread.
+ *
+ * Borrows a slot (polling so that stop() is noticed even while every slot is
+ * held downstream), decodes into it, stamps it and queues it. Grabbing
+ * continuously also keeps the driver's own buffer drained, so the newest
+ * queued frame is never older than one grab interval.
+ */
+void FrameCapture::captureLoop() {
+  if (onStart) {
+    onStart();
+  }
+  // Runs the exit hook on every way out of the loop
+  struct ExitHook {
+    const std::function<void()>& hook;
+    ~ExitHook() {
+      if (hook) {
+        hook();
+      }
+    }
+  } exitHook{onExit};
+
+  while (true) {
+    FrameHandle frame;
+    while (!frame) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+          return;
+        }
+        // Rather than stall the device, recycle the stalest queued frame
+        if (policy == CapturePolicy::kLatestFrame && count > 0 &&
+            pool.available() == 0) {
+          dropOldest();
+        }
+      }
+      frame = pool.acquire(std::chrono::milliseconds(50));
+    }
+
+    bool grabbed = false;
+    {
+      TraceScope scope("capture", static_cast<int64_t>(captured.load()));
+      grabbed = grab(frame.mat());
+    }
+    if (!grabbed) {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+      not_empty.notify_all();
+      return;
+    }
+    frame.setCaptureInfo(captured++, std::chrono::steady_clock::now());
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (policy == CapturePolicy::kLatestFrame) {
+      if (count == ring.size()) {
+        dropOldest();
+      }
+    } else {
+      not_full.wait(lock, [this] { return count < ring.size() || !running; });
+    }
+    if (!running) {
+      return;
+    }
+    ring[(head + count) % ring.size()] = std::move(frame);
+    ++count;
+    lock.unlock();
+    not_empty.notify_one();
+  }
+}
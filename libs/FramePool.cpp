@@ -0,0 +1,184 @@
+/**
+ * @file FramePool.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the FramePool and FrameHandle classes.
+ * @version 0.1
+ * @date 2024-11-08
+ */
+
+#include "FramePool.hpp"
+
+#include <stdexcept>
+
+FrameHandle::FrameHandle(FramePool* pool, int index)
+    : pool(pool), index(index) {}
+
+FrameHandle::FrameHandle(const FrameHandle& other)
+    : pool(other.pool), index(other.index) {
+  if (pool) {
+    pool->retain(index);
+  }
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept
+    : pool(other.pool), index(other.index) {
+  other.pool = nullptr;
+  other.index = -1;
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+  if (this != &other) {
+    if (other.pool) {
+      other.pool->retain(other.index);
+    }
+    reset();
+    pool = other.pool;
+    index = other.index;
+  }
+  return *this;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+  if (this != &other) {
+    reset();
+    pool = other.pool;
+    index = other.index;
+    other.pool = nullptr;
+    other.index = -1;
+  }
+  return *this;
+}
+
+FrameHandle::~FrameHandle() { reset(); }
+
+cv::Mat& FrameHandle::mat() const {
+  if (!pool) {
+    throw std::logic_error("Accessing the frame of an empty FrameHandle");
+  }
+  return pool->slots[index].mat;
+}
+
+void FrameHandle::setCaptureInfo(
+    uint64_t sequence, std::chrono::steady_clock::time_point time) const {
+  FramePool::Slot& slot = pool->slots[index];
+  slot.sequence = sequence;
+  slot.captured = time;
+}
+
+uint64_t FrameHandle::sequence() const { return pool->slots[index].sequence; }
+
+std::chrono::steady_clock::time_point FrameHandle::captureTime() const {
+  return pool->slots[index].captured;
+}
+
+void FrameHandle::reset() {
+  if (pool) {
+    pool->release(index);
+    pool = nullptr;
+    index = -1;
+  }
+}
+
+/**
+ * @brief Constructor for the FramePool class.
+ *
+ * Allocates every slot up front and records its data pointer so later
+ * reallocations by producers can be detected and counted.
+ *
+ * @param capacity Number of frame slots.
+ * @param size Frame size each slot is allocated with.
+ * @param type OpenCV element type of the slots.
+ */
+FramePool::FramePool(size_t capacity, const cv::Size& size, int type)
+    : slot_count(capacity), slots(new Slot[capacity]) {
+  if (capacity == 0) {
+    throw std::invalid_argument("FramePool needs at least one slot");
+  }
+  free_slots.reserve(capacity);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].mat.create(size, type);
+    slots[i].buffer = slots[i].mat.data;
+    free_slots.push_back(static_cast<int>(capacity - 1 - i));
+  }
+}
+
+/**
+ * @brief Borrows a free slot, waiting up to the given timeout.
+ * @param timeout Longest time to wait for a slot.
+ * @return A handle to the slot, or an empty handle on timeout.
+ */
+FrameHandle FramePool::acquire(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (!slot_freed.wait_for(lock, timeout,
+                           [this] { return !free_slots.empty(); })) {
+    return FrameHandle();
+  }
+  return take();
+}
+
+/**
+ * @brief Borrows a free slot without waiting.
+ * @return A handle to the slot, or an empty handle if none is free.
+ */
+FrameHandle FramePool::tryAcquire() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (free_slots.empty()) {
+    return FrameHandle();
+  }
+  return take();
+}
+
+/**
+ * @brief Deep-copies a frame into a newly borrowed slot.
+ * @param source Frame to copy.
+ * @return Handle to the copy, or an empty handle if no slot is free.
+ */
+FrameHandle FramePool::copy(const FrameHandle& source) {
+  FrameHandle target = tryAcquire();
+  if (target && source) {
+    source.mat().copyTo(target.mat());
+    target.setCaptureInfo(source.sequence(), source.captureTime());
+    ++copy_count;
+  }
+  return target;
+}
+
+/**
+ * @brief Number of currently free slots.
+ */
+size_t FramePool::available() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return free_slots.size();
+}
+
+/**
+ * @brief Pops a free slot; the caller holds the mutex.
+ */
+FrameHandle FramePool::take() {
+  int index = free_slots.back();
+  free_slots.pop_back();
+  slots[index].refs.store(1);
+  return FrameHandle(this, index);
+}
+
+void FramePool::retain(int index) { slots[index].refs.fetch_add(1); }
+
+/**
+ * @brief Drops one reference and returns the slot once it is unused.
+ */
+void FramePool::release(int index) {
+  Slot& slot = slots[index];
+  if (slot.refs.fetch_sub(1) != 1) {
+    return;
+  }
+  if (slot.mat.data != slot.buffer) {
+    // A producer wrote a differently sized frame and the slot reallocated
+    ++allocation_count;
+    slot.buffer = slot.mat.data;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_slots.push_back(index);
+  }
+  slot_freed.notify_one();
+}
@@ -0,0 +1,225 @@
+/**
+ * @file InferenceEngine.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the OpenCV DNN and synthetic inference engines.
+ * @version 0.1
+ * @date 2024-11-19
+ */
+
+#include "InferenceEngine.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * @brief Constructor for the OpenCvDnnEngine class.
+ * @param net Network owned by loadModel.
+ */
+OpenCvDnnEngine::OpenCvDnnEngine(cv::dnn::Net& net) : net(net) {}
+
+/**
+ * @brief Runs the network on the blob.
+ * @param blob Input blob.
+ * @param outs Receives the output layers.
+ */
+void OpenCvDnnEngine::forward(const cv::Mat& blob,
+                              std::vector<cv::Mat>& outs) {
+  if (outNames.empty()) {
+    outNames = net.getUnconnectedOutLayersNames();
+  }
+  net.setInput(blob);
+  net.forward(outs, outNames);
+}
+
+/**
+ * @brief Constructor for the SyntheticEngine class; places the people.
+ * @param config Scene, output layout and simulated latency.
+ */
+SyntheticEngine::SyntheticEngine(const SyntheticSceneConfig& config)
+    : config(config), rng(config.seed) {
+  if (config.people < 0 || config.rowsPerPerson < 1 ||
+      config.numClasses < 1 || config.outputRows.empty()) {
+    throw std::invalid_argument(
+        "Synthetic output layout cannot hold the scripted scene");
+  }
+
+  // Row k of a person goes to output k % outputs; each output must have a
+  // distinct row for every report it receives
+  const int outputCount = static_cast<int>(config.outputRows.size());
+  for (int output = 0; output < outputCount; ++output) {
+    const int reports =
+        (config.rowsPerPerson - output + outputCount - 1) / outputCount;
+    if (config.outputRows[output] < config.people * reports) {
+      throw std::invalid_argument(
+          "Synthetic output layout cannot hold the scripted scene");
+    }
+  }
+
+  // A fixed random order of each output's rows; every frame takes
+  // consecutive entries from a random start, so no row is used twice
+  rowOrder.resize(outputCount);
+  for (int output = 0; output < outputCount; ++output) {
+    std::vector<int>& order = rowOrder[output];
+    order.resize(config.outputRows[output]);
+    for (int i = 0; i < static_cast<int>(order.size()); ++i) {
+      order[i] = i;
+    }
+    for (int i = static_cast<int>(order.size()) - 1; i > 0; --i) {
+      std::swap(order[i], order[rng.uniform(0, i + 1)]);
+    }
+  }
+
+  people.reserve(config.people);
+  for (int i = 0; i < config.people; ++i) {
+    Person person;
+    float height = rng.uniform(config.minHeight, config.maxHeight);
+    person.size = cv::Size2f(height * config.aspect, height);
+    person.center = cv::Point2f(
+        rng.uniform(person.size.width / 2, 1.0f - person.size.width / 2),
+        rng.uniform(person.size.height / 2, 1.0f - person.size.height / 2));
+    person.velocity = cv::Point2f(rng.uniform(-config.speed, config.speed),
+                                  rng.uniform(-config.speed, config.speed));
+    person.score = rng.uniform(0.8f, 0.98f);
+    people.push_back(person);
+  }
+  written.reserve(people.size() * config.rowsPerPerson);
+}
+
+/**
+ * @brief Emits the current scene, then advances it by one frame.
+ *
+ * Background rows carry low objectness, as in a real YOLO grid, so the
+ * decode loop does the same amount of work. Each person is reported by
+ * several rows spread over the outputs with slightly jittered boxes and
+ * decreasing scores, which NMS has to merge.
+ *
+ * @param blob Input blob; only its batch size is used.
+ * @param outs Receives the output matrices.
+ */
+void SyntheticEngine::forward(const cv::Mat& blob,
+                              std::vector<cv::Mat>& outs) {
+  const int items = blob.dims == 4 ? std::max(blob.size[0], 1) : 1;
+  const int cols = 5 + config.numClasses;
+
+  if (items != batch) {
+    batch = items;
+    written.clear();
+    outputs.clear();
+    for (int rows : config.outputRows) {
+      cv::Mat out(rows * batch, cols, CV_32F, cv::Scalar(0));
+      for (int r = 0; r < out.rows; ++r) {
+        float* row = out.ptr<float>(r);
+        row[0] = rng.uniform(0.0f, 1.0f);
+        row[1] = rng.uniform(0.0f, 1.0f);
+        row[2] = rng.uniform(0.01f, 0.2f);
+        row[3] = rng.uniform(0.01f, 0.2f);
+        row[4] = rng.uniform(0.0f, config.noiseObjectness);
+      }
+      outputs.push_back(out);
+    }
+  }
+  clearPeople();
+
+  nextRow.resize(outputs.size());
+  for (size_t output = 0; output < outputs.size(); ++output) {
+    nextRow[output] = rng.uniform(0, config.outputRows[output]);
+  }
+  for (const auto& person : people) {
+    for (int k = 0; k < config.rowsPerPerson; ++k) {
+      const int output = k % static_cast<int>(outputs.size());
+      const int rows = config.outputRows[output];
+      const int row = rowOrder[output][nextRow[output]++ % rows];
+      const float score = person.score - 0.05f * k;
+      for (int item = 0; item < batch; ++item) {
+        float* values = outputs[output].ptr<float>(item * rows + row);
+        values[0] = person.center.x + rng.uniform(-config.jitter, config.jitter);
+        values[1] = person.center.y + rng.uniform(-config.jitter, config.jitter);
+        values[2] = person.size.width;
+        values[3] = person.size.height;
+        values[4] = score;
+        values[5] = score;
+      }
+      written.emplace_back(output, row);
+    }
+  }
+
+  outs.assign(outputs.begin(), outputs.end());
+
+  if (config.forwardLatency.count() > 0) {
+    std::this_thread::sleep_for(config.forwardLatency);
+  }
+
+  // Walk every person one step, bouncing off the frame edges
+  for (auto& person : people) {
+    person.center += person.velocity;
+    const float halfWidth = person.size.width / 2;
+    const float halfHeight = person.size.height / 2;
+    if (person.center.x < halfWidth || person.center.x > 1.0f - halfWidth) {
+      person.velocity.x = -person.velocity.x;
+      person.center.x =
+          std::min(std::max(person.center.x, halfWidth), 1.0f - halfWidth);
+    }
+    if (person.center.y < halfHeight || person.center.y > 1.0f - halfHeight) {
+      person.velocity.y = -person.velocity.y;
+      person.center.y =
+          std::min(std::max(person.center.y, halfHeight), 1.0f - halfHeight);
+    }
+  }
+  ++frames;
+}
+
+/**
+ * @brief Turns the rows of the previous frame back into background rows.
+ */
+void SyntheticEngine::clearPeople() {
+  for (const auto& [output, row] : written) {
+    const int rows = config.outputRows[output];
+    for (int item = 0; item < batch; ++item) {
+      float* values = outputs[output].ptr<float>(item * rows + row);
+      values[4] = 0.0f;
+      values[5] = 0.0f;
+    }
+  }
+  written.clear();
+}
+
+/**
+ * @brief Converts the current scene to pixel boxes, the same way the
+ * decode loop converts center-size rows.
+ * @param frameSize Frame the boxes are mapped to.
+ * @return One box per person.
+ */
+std::vector<cv::Rect> SyntheticEngine::groundTruth(
+    const cv::Size& frameSize) const {
+  std::vector<cv::Rect> boxes;
+  boxes.reserve(people.size());
+  for (const auto& person : people) {
+    int centerX = static_cast<int>(person.center.x * frameSize.width);
+    int centerY = static_cast<int>(person.center.y * frameSize.height);
+    int width = static_cast<int>(person.size.width * frameSize.width);
+    int height = static_cast<int>(person.size.height * frameSize.height);
+    boxes.emplace_back(centerX - width / 2, centerY - height / 2, width,
+                       height);
+  }
+  return boxes;
+}
+
+/**
+ * @brief Draws every person with a texture that moves with its box.
+ * @param frame Frame to draw on.
+ */
+void SyntheticEngine::render(cv::Mat& frame) const {
+  const cv::Rect bounds(0, 0, frame.cols, frame.rows);
+  std::vector<cv::Rect> boxes = groundTruth(frame.size());
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    cv::Rect box = boxes[i] & bounds;
+    if (box.empty()) {
+      continue;
+    }
+    cv::Mat roi = frame(box);
+    cv::RNG texture(config.seed + i);
+    texture.fill(roi, cv::RNG::UNIFORM, cv::Scalar::all(120),
+                 cv::Scalar::all(255));
+  }
+}
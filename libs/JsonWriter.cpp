@@ -0,0 +1,28 @@
+/**
+ * @file JsonWriter.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the JSON export helpers.
+ * @version 0.1
+ * @date 2024-11-24
+ */
+
+#include "JsonWriter.hpp"
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ * @param out Stream to write to.
+ * @param text String to write.
+ */
+void writeJsonString(std::ostream& out, const std::string& text) {
+  out << '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
@@ -0,0 +1,76 @@
+/**
+ * @file LatencyStats.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the LatencyStats class.
+ * @version 0.1
+ * @date 2024-11-11
+ */
+
+#include "LatencyStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for the LatencyStats class.
+ * @param window Number of most recent samples kept for percentiles.
+ */
+LatencyStats::LatencyStats(size_t window) : samples(window, 0.0) {
+  if (window == 0) {
+    throw std::invalid_argument("LatencyStats window must be positive");
+  }
+}
+
+/**
+ * @brief Records one latency sample.
+ * @param latency Measured duration.
+ */
+void LatencyStats::record(std::chrono::steady_clock::duration latency) {
+  samples[next] =
+      std::chrono::duration<double, std::milli>(latency).count();
+  next = (next + 1) % samples.size();
+  ++total;
+}
+
+/**
+ * @brief Records the time elapsed since the given starting point.
+ * @param start Start of the measured interval.
+ */
+void LatencyStats::recordSince(std::chrono::steady_clock::time_point start) {
+  record(std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * @brief Computes a latency percentile over the current window using the
+ * nearest-rank method.
+ * @param percent Percentile in [0, 100].
+ * @return Latency in milliseconds, or 0 if nothing was recorded.
+ */
+double LatencyStats::percentile(double percent) const {
+  size_t filled = std::min(total, samples.size());
+  if (filled == 0) {
+    return 0.0;
+  }
+  std::vector<double> sorted(samples.begin(), samples.begin() + filled);
+  percent = std::clamp(percent, 0.0, 100.0);
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * filled));
+  size_t index = rank > 0 ? rank - 1 : 0;
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+/**
+ * @brief Formats p50, p90, p99 and max in milliseconds on one line.
+ * @param label Name printed in front of the figures.
+ * @return The summary line.
+ */
+std::string LatencyStats::summary(const std::string& label) const {
+  std::ostringstream line;
+  line << std::fixed << std::setprecision(1) << label << ": n=" << total
+       << " p50=" << percentile(50) << "ms p90=" << percentile(90)
+       << "ms p99=" << percentile(99) << "ms max=" << percentile(100) << "ms";
+  return line.str();
+}
@@ -0,0 +1,303 @@
+/**
+ * @file LayerProfiler.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the LayerProfiler class.
+ * @version 0.1
+ * @date 2024-11-24
+ */
+
+#include "LayerProfiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "JsonWriter.hpp"
+
+namespace {
+
+/// Bytes in a mebibyte, for the text report.
+constexpr double kMiB = 1024.0 * 1024.0;
+
+/**
+ * @brief Formats a shape as e.g. "1x3x416x416".
+ */
+std::string shapeText(const cv::dnn::MatShape& shape) {
+  std::string text;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    text += (i ? "x" : "") + std::to_string(shape[i]);
+  }
+  return text;
+}
+
+/**
+ * @brief Reads type, FLOPs and memory of every layer at an input shape.
+ * @param net Loaded network.
+ * @param shape Input shape.
+ * @return Layers in the order of getPerfProfile's timings.
+ */
+std::vector<LayerCost> describeNet(cv::dnn::Net& net,
+                                   const cv::dnn::MatShape& shape) {
+  std::vector<int> memoryIds;
+  std::vector<size_t> weights;
+  std::vector<size_t> blobs;
+  net.getMemoryConsumption(shape, memoryIds, weights, blobs);
+
+  std::vector<LayerCost> layers;
+  for (const auto& name : net.getLayerNames()) {
+    LayerCost layer;
+    layer.id = net.getLayerId(name);
+    layer.name = name;
+    cv::Ptr<cv::dnn::Layer> impl = net.getLayer(layer.id);
+    layer.type = impl ? impl->type : "unknown";
+    layer.flops = net.getFLOPS(layer.id, shape);
+    auto found = std::find(memoryIds.begin(), memoryIds.end(), layer.id);
+    if (found != memoryIds.end()) {
+      const size_t index = found - memoryIds.begin();
+      layer.weightBytes = index < weights.size() ? weights[index] : 0;
+      layer.blobBytes = index < blobs.size() ? blobs[index] : 0;
+    }
+    layers.push_back(std::move(layer));
+  }
+  return layers;
+}
+
+}  // namespace
+
+/**
+ * @brief Constructor for the LayerProfiler class.
+ * @param maxFrames Frames to profile, 0 for all.
+ */
+LayerProfiler::LayerProfiler(size_t maxFrames) : maxFrames(maxFrames) {}
+
+/**
+ * @brief Adds the per-layer timings of the last forward pass.
+ * @param net Network that ran the pass.
+ * @param blob Input blob of the pass.
+ * @return Whether the pass was added.
+ */
+bool LayerProfiler::collect(cv::dnn::Net& net, const cv::Mat& blob) {
+  if (done() || net.empty() || blob.empty()) {
+    return false;
+  }
+  cv::dnn::MatShape blobShape;
+  for (int i = 0; i < blob.dims; ++i) {
+    blobShape.push_back(blob.size[i]);
+  }
+  if (blobShape != shape) {
+    describe(blobShape, describeNet(net, blobShape));
+  }
+
+  net.getPerfProfile(timings);
+  if (timings.size() != layers.size()) {
+    return false;
+  }
+  const double msPerTick = 1000.0 / cv::getTickFrequency();
+  for (auto& timing : timings) {
+    timing *= msPerTick;
+  }
+  addFrame(timings);
+  return true;
+}
+
+/**
+ * @brief Starts a new profile.
+ * @param inputShape Input shape of the costs.
+ * @param newLayers Layers in timing order.
+ */
+void LayerProfiler::describe(const cv::dnn::MatShape& inputShape,
+                             std::vector<LayerCost> newLayers) {
+  shape = inputShape;
+  layers = std::move(newLayers);
+  frameCount = 0;
+}
+
+/**
+ * @brief Adds one frame's timings.
+ * @param layerMs Forward time of each layer in ms.
+ */
+void LayerProfiler::addFrame(const std::vector<double>& layerMs) {
+  if (layerMs.size() != layers.size()) {
+    throw std::invalid_argument("Layer timings do not match the profile");
+  }
+  for (size_t i = 0; i < layers.size(); ++i) {
+    layers[i].totalMs += layerMs[i];
+  }
+  ++frameCount;
+}
+
+/**
+ * @brief Sorts the layers by forward time.
+ * @return Layers, slowest first; ties keep network order.
+ */
+std::vector<LayerCost> LayerProfiler::byLayer() const {
+  std::vector<LayerCost> sorted = layers;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const LayerCost& a, const LayerCost& b) {
+                     return a.totalMs > b.totalMs;
+                   });
+  return sorted;
+}
+
+/**
+ * @brief Sums the layers of each type.
+ * @return Types, slowest first; ties in name order.
+ */
+std::vector<LayerTypeCost> LayerProfiler::byType() const {
+  std::map<std::string, LayerTypeCost> types;
+  for (const auto& layer : layers) {
+    LayerTypeCost& type = types[layer.type];
+    type.type = layer.type;
+    ++type.layers;
+    type.flops += layer.flops;
+    type.weightBytes += layer.weightBytes;
+    type.blobBytes += layer.blobBytes;
+    type.totalMs += layer.totalMs;
+  }
+  std::vector<LayerTypeCost> sorted;
+  sorted.reserve(types.size());
+  for (auto& entry : types) {
+    sorted.push_back(std::move(entry.second));
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const LayerTypeCost& a, const LayerTypeCost& b) {
+                     return a.totalMs > b.totalMs;
+                   });
+  return sorted;
+}
+
+/**
+ * @brief Sums the forward time of all layers.
+ * @return Time in ms over all profiled frames.
+ */
+double LayerProfiler::totalMs() const {
+  double total = 0.0;
+  for (const auto& layer : layers) {
+    total += layer.totalMs;
+  }
+  return total;
+}
+
+/**
+ * @brief Formats the profile as tables.
+ * @param topLayers Layers to list, 0 for all.
+ * @return Report text.
+ */
+std::string LayerProfiler::textReport(size_t topLayers) const {
+  std::ostringstream out;
+  if (frameCount == 0) {
+    out << "No layer timings collected";
+    return out.str();
+  }
+  const double frames = static_cast<double>(frameCount);
+  const double total = totalMs();
+  int64_t flops = 0;
+  size_t weightBytes = 0;
+  size_t blobBytes = 0;
+  for (const auto& layer : layers) {
+    flops += layer.flops;
+    weightBytes += layer.weightBytes;
+    blobBytes += layer.blobBytes;
+  }
+  auto share = [total](double ms) {
+    return total > 0.0 ? 100.0 * ms / total : 0.0;
+  };
+
+  out << std::fixed << std::setprecision(2) << "Layer profile over "
+      << frameCount << " frame(s), input " << shapeText(shape) << ": "
+      << total / frames << " ms/frame in " << layers.size() << " layers, "
+      << flops / 1e9 << " GFLOP, weights " << weightBytes / kMiB
+      << " MiB, blobs " << blobBytes / kMiB << " MiB\n\n";
+
+  out << std::left << std::setw(20) << "type" << std::right << std::setw(7)
+      << "layers" << std::setw(11) << "ms/frame" << std::setw(8) << "share"
+      << std::setw(10) << "GFLOP" << std::setw(12) << "weight MiB"
+      << std::setw(10) << "blob MiB" << "\n";
+  for (const auto& type : byType()) {
+    out << std::left << std::setw(20) << type.type << std::right
+        << std::setw(7) << type.layers << std::setw(11)
+        << type.totalMs / frames << std::setw(7) << share(type.totalMs)
+        << "%" << std::setw(10) << type.flops / 1e9 << std::setw(12)
+        << type.weightBytes / kMiB << std::setw(10) << type.blobBytes / kMiB
+        << "\n";
+  }
+
+  std::vector<LayerCost> sorted = byLayer();
+  if (topLayers > 0 && sorted.size() > topLayers) {
+    sorted.resize(topLayers);
+  }
+  out << "\n" << std::left << std::setw(20) << "layer" << std::setw(20)
+      << "type" << std::right << std::setw(11) << "ms/frame" << std::setw(8)
+      << "share" << std::setw(10) << "GFLOP" << std::setw(12)
+      << "weight MiB" << std::setw(10) << "blob MiB" << "\n";
+  for (const auto& layer : sorted) {
+    out << std::left << std::setw(20) << layer.name << std::setw(20)
+        << layer.type << std::right << std::setw(11) << layer.totalMs / frames
+        << std::setw(7) << share(layer.totalMs) << "%" << std::setw(10)
+        << layer.flops / 1e9 << std::setw(12) << layer.weightBytes / kMiB
+        << std::setw(10) << layer.blobBytes / kMiB << "\n";
+  }
+  return out.str();
+}
+
+/**
+ * @brief Formats the profile as JSON with per-frame times.
+ * @return JSON object text.
+ */
+std::string LayerProfiler::jsonReport() const {
+  const double frames = frameCount > 0 ? static_cast<double>(frameCount) : 1.0;
+  const double total = totalMs();
+  std::ostringstream out;
+  out << std::setprecision(6) << "{\"frames\":" << frameCount
+      << ",\"inputShape\":[";
+  for (size_t i = 0; i < shape.size(); ++i) {
+    out << (i ? "," : "") << shape[i];
+  }
+  out << "],\"msPerFrame\":" << total / frames << ",\n\"types\":[";
+
+  bool first = true;
+  for (const auto& type : byType()) {
+    out << (first ? "\n" : ",\n") << "{\"type\":";
+    writeJsonString(out, type.type);
+    out << ",\"layers\":" << type.layers
+        << ",\"msPerFrame\":" << type.totalMs / frames
+        << ",\"share\":" << (total > 0.0 ? type.totalMs / total : 0.0)
+        << ",\"flops\":" << type.flops
+        << ",\"weightBytes\":" << type.weightBytes
+        << ",\"blobBytes\":" << type.blobBytes << "}";
+    first = false;
+  }
+  out << "],\n\"layers\":[";
+
+  first = true;
+  for (const auto& layer : byLayer()) {
+    out << (first ? "\n" : ",\n") << "{\"id\":" << layer.id << ",\"name\":";
+    writeJsonString(out, layer.name);
+    out << ",\"type\":";
+    writeJsonString(out, layer.type);
+    out << ",\"msPerFrame\":" << layer.totalMs / frames
+        << ",\"share\":" << (total > 0.0 ? layer.totalMs / total : 0.0)
+        << ",\"flops\":" << layer.flops
+        << ",\"weightBytes\":" << layer.weightBytes
+        << ",\"blobBytes\":" << layer.blobBytes << "}";
+    first = false;
+  }
+  out << "]}\n";
+  return out.str();
+}
+
+/**
+ * @brief Writes the JSON report.
+ * @param path Output file.
+ */
+void LayerProfiler::writeJson(const std::string& path) const {
+  std::ofstream out(path);
+  out << jsonReport();
+  if (!out) {
+    throw std::runtime_error("Could not write layer profile to " + path);
+  }
+}
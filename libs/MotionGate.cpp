@@ -0,0 +1,79 @@
+/**
+ * @file MotionGate.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the MotionGate class used to skip inference on
+ * static scenes.
+ * @version 0.1
+ * @date 2024-11-06
+ */
+
+#include "MotionGate.hpp"
+
+/**
+ * @brief Constructor for the MotionGate class.
+ * @param config Downsampling, threshold and refresh parameters.
+ */
+MotionGate::MotionGate(const MotionGateConfig& config) : config(config) {}
+
+/**
+ * @brief Decides whether the detector should run on the given frame.
+ *
+ * The frame is shrunk with area interpolation (which also averages sensor
+ * noise), converted to grayscale, blurred with a 3x3 kernel and compared
+ * against the reference frame. The comparison is a single absdiff followed
+ * by a binary threshold and countNonZero, all of which are SIMD-optimized in
+ * OpenCV and touch only analysisSize pixels.
+ *
+ * @param frame Current BGR or grayscale frame.
+ * @return true if the detector should run, false to reuse previous results.
+ */
+bool MotionGate::shouldDetect(const cv::Mat& frame) {
+  ++frames_seen;
+
+  cv::resize(frame, small, config.analysisSize, 0, 0, cv::INTER_AREA);
+  if (small.channels() == 3) {
+    cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+  } else {
+    small.copyTo(gray);
+  }
+  cv::GaussianBlur(gray, gray, cv::Size(3, 3), 0);
+
+  bool refreshDue = config.refreshInterval > 0 &&
+                    frames_since_detect + 1 >= config.refreshInterval;
+  bool changed = true;
+  if (!reference.empty()) {
+    cv::absdiff(gray, reference, diff);
+    cv::threshold(diff, diff, config.pixelThreshold, 255, cv::THRESH_BINARY);
+    last_changed_fraction =
+        static_cast<double>(cv::countNonZero(diff)) / diff.total();
+    changed = last_changed_fraction > config.changedFraction;
+  }
+
+  if (changed || refreshDue) {
+    // The detector runs on this frame, so it becomes the new reference
+    cv::swap(gray, reference);
+    frames_since_detect = 0;
+    return true;
+  }
+
+  ++frames_since_detect;
+  ++frames_skipped;
+  return false;
+}
+
+/**
+ * @brief Forgets the reference frame so the next frame is always detected.
+ */
+void MotionGate::reset() {
+  reference.release();
+  frames_since_detect = 0;
+}
+
+/**
+ * @brief Fraction of evaluated frames for which detection was skipped.
+ * @return Skip rate in [0, 1]; zero before any frame was seen.
+ */
+double MotionGate::skipRate() const {
+  return frames_seen > 0 ? static_cast<double>(frames_skipped) / frames_seen
+                         : 0.0;
+}
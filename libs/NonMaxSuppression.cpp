@@ -0,0 +1,60 @@
+/**
+ * @file NonMaxSuppression.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of greedy non-maximum suppression.
+ * @version 0.1
+ * @date 2024-11-16
+ */
+
+#include "NonMaxSuppression.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Greedy NMS matching cv::dnn::NMSBoxes with eta = 1 and no top-k.
+ *
+ * Candidates above the score threshold are visited best first (ties broken
+ * by index so the order is deterministic without a stable sort buffer); a
+ * candidate is kept if its IoU with every kept box is at most the NMS
+ * threshold.
+ *
+ * @param boxes Candidate boxes.
+ * @param scores Score of each candidate.
+ * @param scoreThreshold Candidates scoring at or below this are ignored.
+ * @param nmsThreshold IoU above which a box is suppressed.
+ * @param indices Receives indices of the kept boxes.
+ */
+void nmsBoxes(const std::pmr::vector<cv::Rect>& boxes,
+              const std::pmr::vector<float>& scores, float scoreThreshold,
+              float nmsThreshold, std::pmr::vector<int>& indices) {
+  indices.clear();
+  std::pmr::vector<int> order(indices.get_allocator());
+  order.reserve(boxes.size());
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    if (scores[i] > scoreThreshold) {
+      order.push_back(static_cast<int>(i));
+    }
+  }
+  std::sort(order.begin(), order.end(), [&scores](int a, int b) {
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+  });
+
+  indices.reserve(order.size());
+  for (int candidate : order) {
+    const cv::Rect& box = boxes[candidate];
+    bool keep = true;
+    for (int kept : indices) {
+      const cv::Rect& other = boxes[kept];
+      int intersection = (box & other).area();
+      int unionArea = box.area() + other.area() - intersection;
+      if (unionArea > 0 &&
+          static_cast<float>(intersection) / unionArea > nmsThreshold) {
+        keep = false;
+        break;
+      }
+    }
+    if (keep) {
+      indices.push_back(candidate);
+    }
+  }
+}
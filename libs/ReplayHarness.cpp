@@ -0,0 +1,253 @@
+/**
+ * @file ReplayHarness.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the record-and-replay harness.
+ * @version 0.1
+ * @date 2024-11-18
+ */
+
+#include "ReplayHarness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief File name of a frame inside a sequence directory.
+ */
+std::string framePath(const std::string& directory, size_t index) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "frame_%06zu.png", index);
+  return (std::filesystem::path(directory) / name).string();
+}
+
+/**
+ * @brief Largest coordinate difference between two boxes.
+ */
+int boxDistance(const cv::Rect& a, const cv::Rect& b) {
+  return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y),
+                   std::abs(a.width - b.width),
+                   std::abs(a.height - b.height)});
+}
+
+}  // namespace
+
+/**
+ * @brief Constructor for the SequenceRecorder class.
+ * @param directory Output directory, created if missing.
+ */
+SequenceRecorder::SequenceRecorder(const std::string& directory)
+    : directory(directory) {
+  std::filesystem::create_directories(directory);
+  detections.open(
+      (std::filesystem::path(directory) / "detections.txt").string());
+  if (!detections) {
+    throw std::runtime_error("Cannot write sequence to: " + directory);
+  }
+}
+
+/**
+ * @brief Writes a frame as PNG and appends its detections.
+ * @param frame Frame before any overlay was drawn.
+ * @param frameDetections Detections consumed for the frame.
+ */
+void SequenceRecorder::record(const cv::Mat& frame,
+                              const std::vector<cv::Rect>& frameDetections) {
+  if (!cv::imwrite(framePath(directory, frames), frame)) {
+    throw std::runtime_error("Cannot write frame " + std::to_string(frames));
+  }
+  detections << frames << ' ' << frameDetections.size();
+  for (const auto& box : frameDetections) {
+    detections << ' ' << box.x << ' ' << box.y << ' ' << box.width << ' '
+               << box.height;
+  }
+  detections << '\n' << std::flush;
+  ++frames;
+}
+
+/**
+ * @brief Loads a recorded sequence.
+ * @param directory Sequence directory.
+ * @param decodeLatency Optional sink for per-frame decode times.
+ * @return The sequence with all frames decoded.
+ */
+RecordedSequence RecordedSequence::load(const std::string& directory,
+                                        LatencyStats* decodeLatency) {
+  std::ifstream file(
+      (std::filesystem::path(directory) / "detections.txt").string());
+  if (!file) {
+    throw std::runtime_error("No recorded sequence in: " + directory);
+  }
+
+  RecordedSequence sequence;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    size_t index = 0;
+    size_t count = 0;
+    if (!(fields >> index >> count) || index != sequence.frames.size()) {
+      throw std::runtime_error("Malformed detections.txt in: " + directory);
+    }
+    std::vector<cv::Rect> boxes(count);
+    for (auto& box : boxes) {
+      if (!(fields >> box.x >> box.y >> box.width >> box.height)) {
+        throw std::runtime_error("Malformed detections.txt in: " + directory);
+      }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    cv::Mat frame = cv::imread(framePath(directory, index));
+    if (decodeLatency) {
+      decodeLatency->recordSince(start);
+    }
+    if (frame.empty()) {
+      throw std::runtime_error("Missing frame " + std::to_string(index) +
+                               " in: " + directory);
+    }
+    sequence.frames.push_back(frame);
+    sequence.detections.push_back(std::move(boxes));
+  }
+  return sequence;
+}
+
+/**
+ * @brief Replays a sequence through the tracker's association and update
+ * step, with the recorded detections standing in for the network.
+ * @param tracker Tracker to drive.
+ * @param sequence Recorded frames and detections.
+ * @return Tracks, frame rate and latencies.
+ */
+ReplayReport replaySequence(Tracker& tracker,
+                            const RecordedSequence& sequence) {
+  ReplayReport report;
+  report.tracks.reserve(sequence.frames.size());
+  cv::Mat canvas;
+  std::chrono::steady_clock::duration tracking{0};
+
+  for (size_t i = 0; i < sequence.frames.size(); ++i) {
+    sequence.frames[i].copyTo(canvas);
+
+    auto start = std::chrono::steady_clock::now();
+    tracker.updateTrackers(sequence.detections[i], canvas);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    report.trackLatency.record(elapsed);
+    tracking += elapsed;
+
+    FrameTracks tracks;
+    for (const auto& slot : tracker.getTrackSlots()) {
+      if (slot.active) {
+        tracks.push_back({slot.id, slot.box});
+      }
+    }
+    std::sort(tracks.begin(), tracks.end(),
+              [](const TrackRecord& a, const TrackRecord& b) {
+                return a.id < b.id;
+              });
+    report.tracks.push_back(std::move(tracks));
+  }
+
+  report.frames = sequence.frames.size();
+  double seconds = std::chrono::duration<double>(tracking).count();
+  report.fps = seconds > 0.0 ? report.frames / seconds : 0.0;
+  return report;
+}
+
+/**
+ * @brief Writes tracks in the golden file format.
+ * @param path Output file.
+ * @param tracks Tracks per frame.
+ */
+void writeTracks(const std::string& path,
+                 const std::vector<FrameTracks>& tracks) {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Cannot write tracks to: " + path);
+  }
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    file << i << ' ' << tracks[i].size();
+    for (const auto& track : tracks[i]) {
+      file << ' ' << track.id << ' ' << track.box.x << ' ' << track.box.y
+           << ' ' << track.box.width << ' ' << track.box.height;
+    }
+    file << '\n';
+  }
+}
+
+/**
+ * @brief Reads tracks in the golden file format.
+ * @param path Golden file.
+ * @return Tracks per frame.
+ */
+std::vector<FrameTracks> readTracks(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Cannot read tracks from: " + path);
+  }
+  std::vector<FrameTracks> tracks;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    size_t index = 0;
+    size_t count = 0;
+    if (!(fields >> index >> count) || index != tracks.size()) {
+      throw std::runtime_error("Malformed track file: " + path);
+    }
+    FrameTracks frame(count);
+    for (auto& track : frame) {
+      if (!(fields >> track.id >> track.box.x >> track.box.y >>
+            track.box.width >> track.box.height)) {
+        throw std::runtime_error("Malformed track file: " + path);
+      }
+    }
+    tracks.push_back(std::move(frame));
+  }
+  return tracks;
+}
+
+/**
+ * @brief Compares tracks frame by frame: same ids, boxes within tolerance.
+ * @param actual Replayed tracks.
+ * @param golden Expected tracks.
+ * @param tolerance Allowed per-coordinate difference in pixels.
+ * @return Mismatch messages.
+ */
+std::vector<std::string> compareTracks(const std::vector<FrameTracks>& actual,
+                                       const std::vector<FrameTracks>& golden,
+                                       int tolerance) {
+  std::vector<std::string> mismatches;
+  if (actual.size() != golden.size()) {
+    mismatches.push_back("Replayed " + std::to_string(actual.size()) +
+                         " frames, golden has " +
+                         std::to_string(golden.size()));
+  }
+  const size_t frames = std::min(actual.size(), golden.size());
+  for (size_t i = 0; i < frames; ++i) {
+    const std::string where = "Frame " + std::to_string(i) + ": ";
+    if (actual[i].size() != golden[i].size()) {
+      mismatches.push_back(where + std::to_string(actual[i].size()) +
+                           " tracks, expected " +
+                           std::to_string(golden[i].size()));
+      continue;
+    }
+    for (size_t t = 0; t < actual[i].size(); ++t) {
+      const TrackRecord& got = actual[i][t];
+      const TrackRecord& want = golden[i][t];
+      if (got.id != want.id) {
+        mismatches.push_back(where + "track id " + std::to_string(got.id) +
+                             ", expected " + std::to_string(want.id));
+      } else if (boxDistance(got.box, want.box) > tolerance) {
+        mismatches.push_back(where + "track " + std::to_string(got.id) +
+                             " is off by " +
+                             std::to_string(boxDistance(got.box, want.box)) +
+                             " px");
+      }
+    }
+  }
+  return mismatches;
+}
@@ -0,0 +1,370 @@
+/**
+ * @file Scheduling.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the per-component scheduler.
+ * @version 0.1
+ * @date 2024-11-20
+ */
+
+#include "Scheduling.hpp"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Reads a CPU-time clock in nanoseconds.
+ * @return -1 if the clock cannot be read, e.g. that of an exited thread.
+ */
+int64_t cpuNanos(clockid_t clock) {
+  timespec ts{};
+  if (clock_gettime(clock, &ts) != 0) {
+    return -1;
+  }
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Cores the calling thread may currently run on.
+ */
+std::vector<int> currentCores() {
+  std::vector<int> cores;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int core = 0; core < CPU_SETSIZE; ++core) {
+      if (CPU_ISSET(core, &set)) {
+        cores.push_back(core);
+      }
+    }
+  }
+#endif
+  if (cores.empty()) {
+    unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned core = 0; core < count; ++core) {
+      cores.push_back(static_cast<int>(core));
+    }
+  }
+  return cores;
+}
+
+/**
+ * @brief Parses "a-b+c+d-e" into a sorted core list.
+ */
+std::vector<int> parseCores(const std::string& text) {
+  std::vector<int> cores;
+  std::istringstream ranges(text);
+  std::string range;
+  while (std::getline(ranges, range, '+')) {
+    size_t dash = range.find('-');
+    try {
+      size_t used = 0;
+      int first = std::stoi(range.substr(0, dash), &used);
+      int last = first;
+      if (dash != std::string::npos) {
+        last = std::stoi(range.substr(dash + 1), &used);
+      } else if (used != range.size()) {
+        throw std::invalid_argument(range);
+      }
+      if (first < 0 || last < first) {
+        throw std::invalid_argument(range);
+      }
+      for (int core = first; core <= last; ++core) {
+        cores.push_back(core);
+      }
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("Malformed core range: " + range);
+    }
+  }
+  std::sort(cores.begin(), cores.end());
+  cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+  return cores;
+}
+
+}  // namespace
+
+std::atomic<uint64_t> Scheduler::next_id{1};
+thread_local uint64_t Scheduler::current_owner = 0;
+thread_local Scheduler::ThreadState* Scheduler::current_state = nullptr;
+
+/**
+ * @brief Returns the spec name of a component.
+ * @param component Component.
+ * @return Its name.
+ */
+const char* componentName(Component component) {
+  switch (component) {
+    case Component::kInference:
+      return "inference";
+    case Component::kTracking:
+      return "tracking";
+    case Component::kCapture:
+      return "capture";
+    case Component::kRender:
+      return "render";
+  }
+  return "unknown";
+}
+
+/**
+ * @brief Parses a schedule spec such as "inference=0-3@4,capture=4".
+ * @param spec Schedule spec.
+ * @return The configuration.
+ */
+SchedulingConfig SchedulingConfig::parse(const std::string& spec) {
+  SchedulingConfig config;
+  std::istringstream entries(spec);
+  std::string entry;
+  while (std::getline(entries, entry, ',')) {
+    size_t equals = entry.find('=');
+    if (equals == std::string::npos) {
+      throw std::invalid_argument("Schedule entry needs component=cores: " +
+                                  entry);
+    }
+    const std::string name = entry.substr(0, equals);
+    std::string cores = entry.substr(equals + 1);
+
+    size_t component = kComponentCount;
+    for (size_t c = 0; c < kComponentCount; ++c) {
+      if (name == componentName(static_cast<Component>(c))) {
+        component = c;
+      }
+    }
+    if (component == kComponentCount) {
+      throw std::invalid_argument("Unknown pipeline component: " + name);
+    }
+
+    size_t at = cores.find('@');
+    if (at != std::string::npos) {
+      if (static_cast<Component>(component) != Component::kInference) {
+        throw std::invalid_argument(
+            "Only inference takes a thread count: " + entry);
+      }
+      try {
+        config.inferenceThreads = std::stoi(cores.substr(at + 1));
+      } catch (const std::logic_error&) {
+        throw std::invalid_argument("Malformed thread count: " + entry);
+      }
+      if (config.inferenceThreads < 1) {
+        throw std::invalid_argument("Thread count must be positive: " +
+                                    entry);
+      }
+      cores = cores.substr(0, at);
+    }
+    config.cores[component] = parseCores(cores);
+  }
+  return config;
+}
+
+/**
+ * @brief Constructor for the Scheduler class.
+ * @param config Core budgets and pinning.
+ */
+Scheduler::Scheduler(const SchedulingConfig& config)
+    : id(next_id.fetch_add(1, std::memory_order_relaxed)),
+      config(config),
+      allowed_cores(currentCores()),
+      created(std::chrono::steady_clock::now()),
+      process_start(cpuNanos(CLOCK_PROCESS_CPUTIME_ID)) {
+  for (size_t c = 0; c < kComponentCount; ++c) {
+    for (int core : config.cores[c]) {
+      if (!std::binary_search(allowed_cores.begin(), allowed_cores.end(),
+                              core)) {
+        throw std::invalid_argument(
+            std::string("Core ") + std::to_string(core) + " of " +
+            componentName(static_cast<Component>(c)) +
+            " is not available to this process");
+      }
+    }
+  }
+  if (config.inferenceThreads > 0) {
+    cv::setNumThreads(config.inferenceThreads);
+  }
+}
+
+/**
+ * @brief Switches the calling thread to a component.
+ * @param component Component to charge from now on.
+ */
+void Scheduler::enter(Component component) {
+  const int index = static_cast<int>(component);
+  bool repin = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ThreadState& state = self();
+    charge(state, cpuNanos(state.clock));
+    state.component = index;
+    if (config.pin && state.pinned != index &&
+        (state.pinned < 0 ||
+         config.cores[state.pinned] != config.cores[index])) {
+      repin = true;
+    }
+    if (config.pin) {
+      state.pinned = index;
+    }
+  }
+  if (repin) {
+    pinTo(config.cores[index]);
+  }
+}
+
+/**
+ * @brief Charges the calling thread's last stretch and forgets it.
+ */
+void Scheduler::leave() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (current_owner != id || current_state == nullptr) {
+    return;
+  }
+  charge(*current_state, cpuNanos(current_state->clock));
+  threads.remove_if(
+      [](const ThreadState& state) { return &state == current_state; });
+  current_owner = 0;
+  current_state = nullptr;
+}
+
+/**
+ * @brief Charges the CPU time since the thread's last enter.
+ * @param state Thread state.
+ * @param now Current CPU time of the thread, -1 if it cannot be read.
+ */
+void Scheduler::charge(ThreadState& state, int64_t now) {
+  if (now < 0) {
+    return;
+  }
+  if (state.component >= 0) {
+    charged[state.component] += now - state.entered;
+  }
+  state.entered = now;
+}
+
+/**
+ * @brief Returns the calling thread's state, registering it on first use.
+ * @return Thread state.
+ */
+Scheduler::ThreadState& Scheduler::self() {
+  if (current_owner != id || current_state == nullptr) {
+    ThreadState state;
+    if (pthread_getcpuclockid(pthread_self(), &state.clock) != 0) {
+      state.clock = CLOCK_THREAD_CPUTIME_ID;
+    }
+    threads.push_back(state);
+    current_owner = id;
+    current_state = &threads.back();
+  }
+  return *current_state;
+}
+
+/**
+ * @brief Sums charged time and the running stretch of live threads.
+ * @return Nanoseconds per component.
+ */
+std::array<int64_t, kComponentCount> Scheduler::chargedNanos() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::array<int64_t, kComponentCount> total = charged;
+  for (const auto& state : threads) {
+    // The fallback clock would read the calling thread's time, so such
+    // threads are only charged by their own enter and leave calls
+    if (state.component < 0 || state.clock == CLOCK_THREAD_CPUTIME_ID) {
+      continue;
+    }
+    // A thread that exited without leave() has no readable clock
+    const int64_t now = cpuNanos(state.clock);
+    if (now >= state.entered) {
+      total[state.component] += now - state.entered;
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief Computes CPU use per component.
+ * @return Usage indexed by Component.
+ */
+std::array<ComponentUsage, kComponentCount> Scheduler::usage() const {
+  const double wall = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - created)
+                          .count();
+  std::array<int64_t, kComponentCount> nanos = chargedNanos();
+  std::array<ComponentUsage, kComponentCount> result;
+  for (size_t c = 0; c < kComponentCount; ++c) {
+    result[c].cpuSeconds = nanos[c] / 1e9;
+    result[c].coresUsed = wall > 0.0 ? result[c].cpuSeconds / wall : 0.0;
+    result[c].coresBudgeted = config.cores[c].size();
+  }
+  return result;
+}
+
+/**
+ * @brief CPU time of the process not charged to any component.
+ * @return Seconds.
+ */
+double Scheduler::unregisteredCpuSeconds() const {
+  int64_t process = cpuNanos(CLOCK_PROCESS_CPUTIME_ID) - process_start;
+  for (int64_t nanos : chargedNanos()) {
+    process -= nanos;
+  }
+  return std::max<int64_t>(process, 0) / 1e9;
+}
+
+/**
+ * @brief Formats the utilization of every component.
+ * @return Report with one line per component.
+ */
+std::string Scheduler::report() const {
+  const double wall = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - created)
+                          .count();
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2)
+      << "component   cpu s    cores used   budget   of budget\n";
+  std::array<ComponentUsage, kComponentCount> components = usage();
+  for (size_t c = 0; c < kComponentCount; ++c) {
+    const ComponentUsage& u = components[c];
+    out << std::left << std::setw(12)
+        << componentName(static_cast<Component>(c)) << std::right
+        << std::setw(5) << u.cpuSeconds << "    " << std::setw(10)
+        << u.coresUsed << "   ";
+    if (u.coresBudgeted > 0) {
+      out << std::setw(6) << u.coresBudgeted << "   " << std::setw(8)
+          << 100.0 * u.coresUsed / u.coresBudgeted << "%\n";
+    } else {
+      out << "   all\n";
+    }
+  }
+  double other = unregisteredCpuSeconds();
+  out << std::left << std::setw(12) << "unassigned" << std::right
+      << std::setw(5) << other << "    " << std::setw(10)
+      << (wall > 0.0 ? other / wall : 0.0)
+      << "   (OpenCV workers, other threads)\n";
+  return out.str();
+}
+
+/**
+ * @brief Sets the calling thread's affinity.
+ * @param cores Cores to run on; empty restores the process's original set.
+ */
+void Scheduler::pinTo(const std::vector<int>& cores) const {
+#ifdef __linux__
+  const std::vector<int>& target = cores.empty() ? allowed_cores : cores;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int core : target) {
+    CPU_SET(core, &set);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    std::cerr << "Could not pin thread to its core set" << std::endl;
+  }
+#else
+  (void)cores;
+#endif
+}
@@ -0,0 +1,70 @@
+/**
+ * @file SpatialGrid.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the SpatialGrid class.
+ * @version 0.1
+ * @date 2024-11-22
+ */
+
+#include "SpatialGrid.hpp"
+
+/**
+ * @brief Empties the grid, keeping its storage.
+ * @param cellSize Cell edge in pixels.
+ * @param expected Number of boxes about to be inserted.
+ */
+void SpatialGrid::reset(int cellSize, size_t expected) {
+  this->cellSize = std::max(cellSize, 1);
+  // About two buckets per box keeps the chains short; boxes usually touch
+  // up to four cells
+  size_t buckets = 64;
+  while (buckets < 2 * expected) {
+    buckets *= 2;
+  }
+  heads.assign(buckets, -1);
+  entries.clear();
+  boxes = 0;
+}
+
+/**
+ * @brief Registers a box in every cell it touches.
+ * @param id Box id.
+ * @param box Box in pixels.
+ */
+void SpatialGrid::insert(int id, const cv::Rect& box) {
+  if (box.empty() || id < 0) {
+    return;
+  }
+  if (heads.empty()) {
+    reset(cellSize, 0);
+  }
+  if (static_cast<size_t>(id) >= seen.size()) {
+    seen.resize(id + 1, 0);
+  }
+  const int lastX = cellOf(box.x + box.width - 1);
+  const int lastY = cellOf(box.y + box.height - 1);
+  for (int cellY = cellOf(box.y); cellY <= lastY; ++cellY) {
+    for (int cellX = cellOf(box.x); cellX <= lastX; ++cellX) {
+      int& head = heads[bucket(cellX, cellY)];
+      entries.push_back({id, cellX, cellY, head});
+      head = static_cast<int>(entries.size()) - 1;
+    }
+  }
+  ++boxes;
+}
+
+/**
+ * @brief Suggests a cell size from the boxes' larger sides.
+ * @param boxes Boxes about to be indexed.
+ * @return Cell edge in pixels.
+ */
+int SpatialGrid::suggestCellSize(const std::vector<cv::Rect>& boxes) {
+  if (boxes.empty()) {
+    return 64;
+  }
+  int64_t total = 0;
+  for (const auto& box : boxes) {
+    total += std::max(box.width, box.height);
+  }
+  return std::max(16, static_cast<int>(total / boxes.size()));
+}
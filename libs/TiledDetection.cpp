@@ -0,0 +1,156 @@
+/**
+ * @file TiledDetection.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the tile layout and cross-tile merge used by tiled
+ * detection.
+ * @version 0.1
+ * @date 2024-11-04
+ */
+
+#include "TiledDetection.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Start offsets of the tiles along one axis.
+ * @param length Frame length along the axis.
+ * @param tile Tile length along the axis.
+ * @param stride Distance between consecutive tile origins.
+ * @return Tile origins; the last tile is aligned to the frame border.
+ */
+std::vector<int> tileOrigins(int length, int tile, int stride) {
+  std::vector<int> origins;
+  if (length <= tile) {
+    origins.push_back(0);
+    return origins;
+  }
+  for (int origin = 0;; origin += stride) {
+    if (origin + tile >= length) {
+      origins.push_back(length - tile);
+      break;
+    }
+    origins.push_back(origin);
+  }
+  return origins;
+}
+
+/**
+ * @brief Check whether a box touches an edge of its tile that lies inside
+ * the frame, i.e. whether the tile may have cut the object.
+ */
+bool isCutBySeam(const TileDetection& det, const cv::Size& frameSize,
+                 int margin) {
+  const cv::Rect& box = det.box;
+  const cv::Rect& tile = det.tile;
+  bool left = tile.x > 0 && box.x <= tile.x + margin;
+  bool top = tile.y > 0 && box.y <= tile.y + margin;
+  bool right = tile.br().x < frameSize.width &&
+               box.br().x >= tile.br().x - margin;
+  bool bottom = tile.br().y < frameSize.height &&
+                box.br().y >= tile.br().y - margin;
+  return left || top || right || bottom;
+}
+
+/**
+ * @brief Intersection over union of two boxes.
+ */
+float iou(const cv::Rect& a, const cv::Rect& b) {
+  int intersection = (a & b).area();
+  int unionArea = a.area() + b.area() - intersection;
+  return unionArea > 0 ? static_cast<float>(intersection) / unionArea : 0.0f;
+}
+
+}  // namespace
+
+std::vector<cv::Rect> computeTiles(const cv::Size& frameSize,
+                                   const TilingConfig& config) {
+  if (config.overlap >= config.tileWidth ||
+      config.overlap >= config.tileHeight || config.overlap < 0) {
+    throw std::invalid_argument(
+        "Tile overlap must be non-negative and smaller than the tile size");
+  }
+
+  int tileWidth = std::min(config.tileWidth, frameSize.width);
+  int tileHeight = std::min(config.tileHeight, frameSize.height);
+  std::vector<int> xs = tileOrigins(frameSize.width, config.tileWidth,
+                                    config.tileWidth - config.overlap);
+  std::vector<int> ys = tileOrigins(frameSize.height, config.tileHeight,
+                                    config.tileHeight - config.overlap);
+
+  std::vector<cv::Rect> tiles;
+  tiles.reserve(xs.size() * ys.size());
+  for (int y : ys) {
+    for (int x : xs) {
+      tiles.emplace_back(x, y, tileWidth, tileHeight);
+    }
+  }
+  return tiles;
+}
+
+std::vector<cv::Rect> mergeTileDetections(
+    const std::vector<TileDetection>& detections, const cv::Size& frameSize,
+    const TilingConfig& config) {
+  // Clip every box to the tile that saw it; YOLO may extrapolate beyond it
+  std::vector<TileDetection> clipped;
+  std::vector<bool> cut;
+  for (const auto& det : detections) {
+    if (det.confidence < config.scoreThreshold) {
+      continue;
+    }
+    TileDetection inside{det.box & det.tile, det.confidence, det.tile};
+    if (inside.box.area() == 0) {
+      continue;
+    }
+    cut.push_back(isCutBySeam(inside, frameSize, config.seamMargin));
+    clipped.push_back(inside);
+  }
+
+  std::vector<size_t> order(clipped.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return clipped[a].confidence > clipped[b].confidence;
+  });
+
+  std::vector<bool> consumed(clipped.size(), false);
+  std::vector<cv::Rect> merged;
+  for (size_t i = 0; i < order.size(); ++i) {
+    size_t keep = order[i];
+    if (consumed[keep]) {
+      continue;
+    }
+    cv::Rect box = clipped[keep].box;
+    bool boxCut = cut[keep];
+
+    for (size_t j = i + 1; j < order.size(); ++j) {
+      size_t other = order[j];
+      if (consumed[other]) {
+        continue;
+      }
+      const cv::Rect& otherBox = clipped[other].box;
+
+      // A person split by a seam: join the fragments instead of dropping one
+      if ((boxCut || cut[other]) && clipped[keep].tile != clipped[other].tile) {
+        int smaller = std::min(box.area(), otherBox.area());
+        float overlap =
+            smaller > 0 ? static_cast<float>((box & otherBox).area()) / smaller
+                        : 0.0f;
+        if (overlap > config.seamMergeThreshold) {
+          box |= otherBox;
+          boxCut = boxCut || cut[other];
+          consumed[other] = true;
+          continue;
+        }
+      }
+
+      if (iou(box, otherBox) > config.nmsThreshold) {
+        consumed[other] = true;
+      }
+    }
+    merged.push_back(box);
+  }
+  return merged;
+}
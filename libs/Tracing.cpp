@@ -0,0 +1,246 @@
+/**
+ * @file Tracing.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the per-thread trace buffers and the Chrome
+ * trace-event export.
+ * @version 0.1
+ * @date 2024-11-23
+ */
+
+#include "Tracing.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "JsonWriter.hpp"
+
+namespace {
+
+/**
+ * @struct TraceEvent
+ * @brief One recorded scope.
+ */
+struct TraceEvent {
+  const char* name;  ///< Stage name.
+  int64_t begin;     ///< Begin time in ns.
+  int64_t end;       ///< End time in ns.
+  int64_t argument;  ///< Attached number or Tracing::kNoArgument.
+};
+
+/**
+ * @struct ThreadBuffer
+ * @brief Events of one thread in a ring; event i is stored at index
+ * i % kEventsPerThread. Only the owning thread writes events, claimed and
+ * count; readers load count, read the last kEventsPerThread events below it
+ * and then check claimed for ones overwritten while they read.
+ */
+struct ThreadBuffer {
+  int tid = 0;                     ///< Thread id in the trace.
+  std::string name;                ///< Thread name, guarded by the registry.
+  std::unique_ptr<TraceEvent[]> events{
+      new TraceEvent[Tracing::kEventsPerThread]};  ///< Event ring.
+  std::atomic<size_t> claimed{0};  ///< Events written or being written.
+  std::atomic<size_t> count{0};    ///< Published events, ever.
+};
+
+/**
+ * @brief Number of a buffer's events still held by its ring.
+ */
+size_t heldEvents(size_t count) {
+  return std::min(count, Tracing::kEventsPerThread);
+}
+
+/**
+ * @struct Registry
+ * @brief Buffers of every thread that ever recorded, kept after the thread
+ * exits so its events can still be exported.
+ */
+struct Registry {
+  std::mutex mutex;  ///< Guards buffers and thread names.
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;  ///< One per thread.
+};
+
+/**
+ * @brief The registry; never destroyed, so threads outliving main's
+ * statics can still record.
+ */
+Registry& registry() {
+  static Registry* instance = new Registry;
+  return *instance;
+}
+
+/// Buffer of the calling thread, registered on first use.
+thread_local ThreadBuffer* current = nullptr;
+
+/**
+ * @brief Returns the calling thread's buffer, registering it if needed.
+ */
+ThreadBuffer& threadBuffer() {
+  if (current == nullptr) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+    current = reg.buffers.back().get();
+    current->tid = static_cast<int>(reg.buffers.size());
+  }
+  return *current;
+}
+
+/// Time origin of the exported trace.
+const int64_t kOrigin = Tracing::now();
+
+}  // namespace
+
+std::atomic<bool> Tracing::active{false};
+
+/**
+ * @brief Starts or stops recording.
+ * @param on Whether to record.
+ */
+void Tracing::setEnabled(bool on) {
+  active.store(on, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Names the calling thread in the trace.
+ * @param name Thread name.
+ */
+void Tracing::setThreadName(const std::string& name) {
+  ThreadBuffer& buffer = threadBuffer();
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  buffer.name = name;
+}
+
+/**
+ * @brief Appends one event to the calling thread's ring, overwriting its
+ * oldest event once the ring is full.
+ * @param name Stage name.
+ * @param begin Begin time in ns.
+ * @param end End time in ns.
+ * @param argument Attached number.
+ */
+void Tracing::record(const char* name, int64_t begin, int64_t end,
+                     int64_t argument) {
+  ThreadBuffer& buffer = threadBuffer();
+  const size_t index = buffer.count.load(std::memory_order_relaxed);
+  // Claim the slot first, so a reader of the event it overwrites notices
+  buffer.claimed.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer.events[index % kEventsPerThread] = {name, begin, end, argument};
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return Nanoseconds.
+ */
+int64_t Tracing::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Writes all events as complete ("X") events, which carry the begin
+ * time and the duration, plus a name record for every named thread.
+ * @param path Output file.
+ * @return Number of events written.
+ */
+size_t Tracing::writeChromeTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Could not write trace to " + path);
+  }
+  const int pid = static_cast<int>(getpid());
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+  size_t written = 0;
+  bool first = true;
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (const auto& buffer : reg.buffers) {
+    if (!buffer->name.empty()) {
+      out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\","
+          << "\"pid\":" << pid << ",\"tid\":" << buffer->tid
+          << ",\"args\":{\"name\":";
+      writeJsonString(out, buffer->name);
+      out << "}}";
+      first = false;
+    }
+    const size_t count = buffer->count.load(std::memory_order_acquire);
+    for (size_t i = count - heldEvents(count); i < count; ++i) {
+      const TraceEvent event = buffer->events[i % kEventsPerThread];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (buffer->claimed.load(std::memory_order_relaxed) - i >
+          kEventsPerThread) {
+        continue;  // Overwritten while it was read
+      }
+      out << (first ? "" : ",\n") << "{\"name\":";
+      writeJsonString(out, event.name);
+      out << ",\"cat\":\"pipeline\",\"ph\":\"X\",\"ts\":"
+          << (event.begin - kOrigin) / 1e3
+          << ",\"dur\":" << (event.end - event.begin) / 1e3
+          << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid;
+      if (event.argument != kNoArgument) {
+        out << ",\"args\":{\"id\":" << event.argument << "}";
+      }
+      out << "}";
+      first = false;
+      ++written;
+    }
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  if (!out) {
+    throw std::runtime_error("Could not write trace to " + path);
+  }
+  return written;
+}
+
+/**
+ * @brief Counts the events held by the rings.
+ * @return Events over all threads.
+ */
+size_t Tracing::eventCount() {
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  size_t total = 0;
+  for (const auto& buffer : reg.buffers) {
+    total += heldEvents(buffer->count.load(std::memory_order_acquire));
+  }
+  return total;
+}
+
+/**
+ * @brief Counts events overwritten by newer ones.
+ * @return Overwritten events over all threads.
+ */
+size_t Tracing::droppedCount() {
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  size_t total = 0;
+  for (const auto& buffer : reg.buffers) {
+    const size_t count = buffer->count.load(std::memory_order_acquire);
+    total += count - heldEvents(count);
+  }
+  return total;
+}
+
+/**
+ * @brief Discards all events; buffers stay registered.
+ */
+void Tracing::clear() {
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (const auto& buffer : reg.buffers) {
+    buffer->count.store(0, std::memory_order_release);
+    buffer->claimed.store(0, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,124 @@
+/**
+ * @file TrackPublisher.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the TrackPublisher class.
+ * @version 0.1
+ * @date 2024-11-21
+ */
+
+#include "TrackPublisher.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for the TrackPublisher class; creates the ring.
+ * @param name Shared-memory object name.
+ * @param slots Ring length.
+ */
+TrackPublisher::TrackPublisher(const std::string& name, size_t slots)
+    : name(name), bytes(trackRingBytes(slots)) {
+  if (slots < 2) {
+    throw std::invalid_argument("Track ring needs at least two slots");
+  }
+
+  // Replace a ring left behind by an earlier run rather than reuse it
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Could not create track ring " + name);
+  }
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error("Could not size track ring " + name);
+  }
+  void* mapped =
+      mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw std::runtime_error("Could not map track ring " + name);
+  }
+
+  // The object comes zero-filled; start the lifetimes of header and slots
+  header = new (mapped) TrackRingHeader{};
+  ring = reinterpret_cast<TrackRingSlot*>(header + 1);
+  for (size_t i = 0; i < slots; ++i) {
+    new (&ring[i]) TrackRingSlot{};
+  }
+  header->layout = kTrackRingLayout;
+  header->slots = static_cast<uint32_t>(slots);
+  header->slotSize = sizeof(TrackRingSlot);
+  header->magic.store(kTrackRingMagic, std::memory_order_release);
+}
+
+TrackPublisher::~TrackPublisher() {
+  munmap(header, bytes);
+  shm_unlink(name.c_str());
+}
+
+/**
+ * @brief Marks the next slot as being written and returns its frame.
+ * @return Frame in the ring slot.
+ */
+TrackFrame& TrackPublisher::beginFrame() {
+  TrackRingSlot& slot = ring[next % header->slots];
+  slot.sequence.store(2 * next + 1, std::memory_order_relaxed);
+  // Keeps the payload writes below from becoming visible before the mark
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.frame.frame = next;
+  slot.frame.captured = 0;
+  slot.frame.count = 0;
+  slot.frame.truncated = 0;
+  return slot.frame;
+}
+
+/**
+ * @brief Stamps the frame and makes it visible to subscribers.
+ */
+void TrackPublisher::commit() {
+  TrackRingSlot& slot = ring[next % header->slots];
+  slot.frame.published = sharedClockNanos();
+  slot.sequence.store(2 * next + 2, std::memory_order_release);
+  ++next;
+  header->published.store(next, std::memory_order_release);
+}
+
+/**
+ * @brief Publishes the tracker's live tracks.
+ * @param tracker Tracker after its Track call for the frame.
+ * @param captured Capture time of the frame, or a default time point.
+ */
+void TrackPublisher::publish(Tracker& tracker,
+                             std::chrono::steady_clock::time_point captured) {
+  TrackFrame& frame = beginFrame();
+  if (captured.time_since_epoch().count() != 0) {
+    frame.captured = toSharedClock(captured);
+  }
+  for (const auto& slot : tracker.getTrackSlots()) {
+    if (!slot.active) {
+      continue;
+    }
+    if (frame.count == kMaxSharedTracks) {
+      ++frame.truncated;
+      continue;
+    }
+    SharedTrack& track = frame.tracks[frame.count++];
+    track.id = slot.id;
+    track.x = slot.box.x;
+    track.y = slot.box.y;
+    track.width = slot.box.width;
+    track.height = slot.box.height;
+    cv::Point3f position = tracker.getLocation(slot.box);
+    track.position[0] = position.x;
+    track.position[1] = position.y;
+    track.position[2] = position.z;
+  }
+  commit();
+}
@@ -0,0 +1,225 @@
+/**
+ * @file TrackRing.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the track ring reader.
+ * @version 0.1
+ * @date 2024-11-21
+ */
+
+#include "TrackRing.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * @brief Reads CLOCK_MONOTONIC.
+ * @return Nanoseconds.
+ */
+int64_t sharedClockNanos() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Converts a steady_clock time point to the shared clock.
+ * @param time Time point.
+ * @return Nanoseconds on the shared clock.
+ */
+int64_t toSharedClock(std::chrono::steady_clock::time_point time) {
+  const int64_t offset =
+      sharedClockNanos() - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now()
+                                   .time_since_epoch())
+                               .count();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             time.time_since_epoch())
+             .count() +
+         offset;
+}
+
+/**
+ * @brief Size of a ring with the given number of slots.
+ * @param slots Number of slots.
+ * @return Bytes.
+ */
+size_t trackRingBytes(size_t slots) {
+  return sizeof(TrackRingHeader) + slots * sizeof(TrackRingSlot);
+}
+
+/**
+ * @brief Constructor for the TrackSubscriber class; maps the ring read-only.
+ * @param name Shared-memory object name.
+ */
+TrackSubscriber::TrackSubscriber(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::runtime_error("No track ring named " + name);
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(TrackRingHeader)) {
+    close(fd);
+    throw std::runtime_error("Track ring " + name + " is not initialised");
+  }
+  bytes = static_cast<size_t>(info.st_size);
+  void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw std::runtime_error("Could not map track ring " + name);
+  }
+  header = static_cast<const TrackRingHeader*>(mapped);
+  ring = reinterpret_cast<const TrackRingSlot*>(header + 1);
+
+  if (header->magic.load(std::memory_order_acquire) != kTrackRingMagic ||
+      header->layout != kTrackRingLayout ||
+      header->slotSize != sizeof(TrackRingSlot) || header->slots < 2 ||
+      bytes < trackRingBytes(header->slots)) {
+    munmap(mapped, bytes);
+    throw std::runtime_error("Track ring " + name +
+                             " is not initialised or has another layout");
+  }
+
+  uint64_t published = header->published.load(std::memory_order_acquire);
+  wanted = published > 0 ? published - 1 : 0;
+}
+
+TrackSubscriber::~TrackSubscriber() {
+  munmap(const_cast<TrackRingHeader*>(header), bytes);
+}
+
+/**
+ * @brief Copies one frame out of its slot under the seqlock.
+ *
+ * Frame n is complete once its slot's counter reads 2n + 2 and is being
+ * written while it reads 2n + 1; any other value means the slot holds
+ * another frame. A write takes microseconds, so a counter that stays at
+ * 2n + 1 for kStallYields yields means the publisher stopped mid-write.
+ * Only the valid tracks are copied.
+ *
+ * @param number Sequence number of the frame.
+ * @param frame Receives the frame.
+ * @return kFrame if read, kLost if the frame is not (or no longer) in its
+ * slot, kStalled if it stayed half-written.
+ */
+ReadStatus TrackSubscriber::read(uint64_t number, TrackFrame& frame) const {
+  constexpr int kStallYields = 100;
+  const TrackRingSlot& slot = ring[number % header->slots];
+  const uint64_t complete = 2 * number + 2;
+  for (int yields = 0;;) {
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before == complete - 1) {
+      if (++yields > kStallYields) {
+        return ReadStatus::kStalled;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    if (before != complete) {
+      return ReadStatus::kLost;
+    }
+
+    std::memcpy(&frame, &slot.frame, offsetof(TrackFrame, tracks));
+    const uint32_t count = std::min<uint32_t>(
+        frame.count, static_cast<uint32_t>(kMaxSharedTracks));
+    std::memcpy(frame.tracks, slot.frame.tracks, count * sizeof(SharedTrack));
+    frame.count = count;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == before) {
+      return ReadStatus::kFrame;
+    }
+  }
+}
+
+/**
+ * @brief Reads the newest published frame.
+ * @param frame Receives the frame.
+ * @return False if nothing has been published or the newest frame stayed
+ * half-written.
+ */
+bool TrackSubscriber::latest(TrackFrame& frame) {
+  while (true) {
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (published == 0) {
+      return false;
+    }
+    if (read(published - 1, frame) == ReadStatus::kFrame) {
+      wanted = std::max(wanted, published);
+      return true;
+    }
+    // Only a newer frame can have overwritten it; otherwise it is stalled
+    if (header->published.load(std::memory_order_acquire) == published) {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief Reads the next unread frame, skipping overwritten ones.
+ * @param frame Receives the frame.
+ * @return Read status.
+ */
+ReadStatus TrackSubscriber::next(TrackFrame& frame) {
+  ReadStatus status = ReadStatus::kFrame;
+  while (true) {
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (wanted >= published) {
+      return ReadStatus::kNoFrame;
+    }
+    // Leave a slot of headroom: the oldest one may be rewritten right now
+    const uint64_t oldest =
+        published > header->slots ? published - header->slots + 1 : 0;
+    if (wanted < oldest) {
+      lost += oldest - wanted;
+      wanted = oldest;
+      status = ReadStatus::kLost;
+    }
+    const ReadStatus result = read(wanted, frame);
+    if (result == ReadStatus::kFrame) {
+      ++wanted;
+      return status;
+    }
+    // A stalled frame is retried until a newer one shows it was abandoned
+    if (result == ReadStatus::kStalled &&
+        header->published.load(std::memory_order_acquire) <= wanted + 1) {
+      return ReadStatus::kStalled;
+    }
+    // Overwritten while we looked; catch up with the publisher
+    ++lost;
+    ++wanted;
+    status = ReadStatus::kLost;
+  }
+}
+
+/**
+ * @brief Waits for the next unread frame.
+ * @param frame Receives the frame.
+ * @param timeout Longest wait.
+ * @return False on timeout.
+ */
+bool TrackSubscriber::waitNext(TrackFrame& frame,
+                               std::chrono::microseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (int spins = 0;; ++spins) {
+    const ReadStatus status = next(frame);
+    if (status == ReadStatus::kFrame || status == ReadStatus::kLost) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    // Spin for the first few microseconds, then give the core away
+    if (spins > 1000) {
+      std::this_thread::yield();
+    }
+  }
+}
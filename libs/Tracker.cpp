@@ -9,9 +9,19 @@
 
 #include "Tracker.hpp"
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
+#include "Tracing.hpp"
+
+namespace {
+
+/// Track slots created up front; the pool grows past this only if needed.
+constexpr size_t kInitialTrackSlots = 16;
+
+}  // namespace
+
 /**
  * @brief Constructor for the Tracker class.
  * @param modelPath Path to the model file used for detection.
@@ -21,7 +31,12 @@
  */
 Tracker::Tracker(const std::string& modelPath, const std::string& configPath,
                  const std::string& classesPath, const cv::Mat& image)
-    : detectHuman(modelPath, configPath, classesPath) {}
+    : detectHuman(modelPath, configPath, classesPath) {
+  slots.resize(kInitialTrackSlots);
+  for (auto& slot : slots) {
+    slot.tracker = cv::TrackerKCF::create();
+  }
+}
 
 /**
  * @brief Tracks humans in the given image frame.
@@ -29,12 +44,58 @@ Tracker::Tracker(const std::string& modelPath, const std::string& configPath,
  * trackers.
  */
 void Tracker::Track(const cv::Mat& Image) {
-  // Detect humans in current frame
-  std::vector<cv::Rect> detections = detectHumans(Image);
-  std::cout << "Detected Humans" << std::endl;
+  // Detect humans in current frame unless the scene has not changed
+  if (!motionGating || motionGate.shouldDetect(Image)) {
+    if (scheduler) {
+      scheduler->enter(Component::kInference);
+    }
+    TraceScope scope("detect");
+    std::pmr::vector<cv::Rect> detections = detectHumans(Image, trackArena);
+    lastDetections.assign(detections.begin(), detections.end());
+  }
 
   // Update tracking information
-  updateTrackers(detections, Image);
+  if (scheduler) {
+    scheduler->enter(Component::kTracking);
+  }
+  updateTrackers(lastDetections, Image);
+
+  // Everything transient from this frame goes at once
+  trackArena.reset();
+}
+
+/**
+ * @brief Counts the live tracks.
+ * @return Number of active slots.
+ */
+size_t Tracker::activeTrackCount() const {
+  size_t count = 0;
+  for (const auto& slot : slots) {
+    count += slot.active ? 1 : 0;
+  }
+  return count;
+}
+
+/**
+ * @brief Enables the motion gate in front of the detector.
+ * @param config Gate parameters, including the forced refresh interval.
+ */
+void Tracker::enableMotionGating(const MotionGateConfig& config) {
+  motionGate = MotionGate(config);
+  motionGating = true;
+}
+
+/**
+ * @brief Replaces the tracking images and drops the live tracks.
+ * @param config Tracking resolution and image.
+ */
+void Tracker::setFrameCache(const FrameCacheConfig& config) {
+  frameCache = FrameCache(config);
+  for (auto& slot : slots) {
+    // KCF keeps feature settings from its first init, e.g. grayscale
+    slot.tracker = cv::TrackerKCF::create();
+    slot.active = false;
+  }
 }
 
 /**
@@ -44,45 +105,88 @@ void Tracker::Track(const cv::Mat& Image) {
  */
 void Tracker::updateTrackers(const std::vector<cv::Rect>& detections,
                              const cv::Mat& Image) {
-  // Update existing trackers and remove failed ones
-  auto it = trackers.begin();
-  while (it != trackers.end()) {
-    cv::Rect trackedRect;
-    if ((*it)->update(Image, trackedRect)) {
-      // Draw tracking information for successful trackers
-      cv::rectangle(Image, trackedRect, cv::Scalar(255, 255, 0), 2);
-      cv::Point3f location = getLocation(trackedRect);
-      cv::putText(Image,
-                  "Tracked: (" + std::to_string(location.x) + ", " +
-                      std::to_string(location.y) + ", " +
-                      std::to_string(location.z) + ")",
-                  cv::Point(trackedRect.x, trackedRect.y - 10),
-                  cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
-      ++it;
+  {
+    TraceScope scope("frame cache");
+    frameCache.update(Image);
+  }
+  const cv::Mat& trackingImage = frameCache.trackingImage();
+
+  // Update existing trackers once and free the slots of failed ones
+  for (auto& slot : slots) {
+    if (!slot.active) {
+      continue;
+    }
+    TraceScope scope("track update", slot.id);
+    cv::Rect tracked;
+    if (slot.tracker->update(trackingImage, tracked)) {
+      slot.box = frameCache.toFrame(tracked);
     } else {
-      it = trackers.erase(it);
+      slot.active = false;
     }
   }
 
-  // Initialize new trackers for newly detected humans
-  for (const auto& det : detections) {
-    bool isNewDetection = true;
-    // Check if detection overlaps with any existing tracker
-    for (const auto& tracker : trackers) {
-      cv::Rect trackedRect;
-      tracker->update(Image, trackedRect);
-      if ((det & trackedRect).area() > 0) {
-        isNewDetection = false;
-        break;
+  free_slot_hint = 0;
+
+  // Initialize new trackers for detections that overlap no live track,
+  // reusing free slots; only the tracks around each detection are tested
+  {
+    TraceScope scope("association");
+    trackGrid.associate(
+        slots.size(),
+        [this](int i) { return slots[i].active ? slots[i].box : cv::Rect(); },
+        detections, [&](const cv::Rect& det) {
+          TrackSlot& slot = acquireSlot();
+          slot.tracker->init(trackingImage, frameCache.toTracking(det));
+          slot.box = det;
+          slot.id = next_track_id++;
+          slot.active = true;
+          return static_cast<int>(&slot - slots.data());
+        });
+  }
+
+  // Draw once every tracker has read the frame, including those just
+  // initialized, since the tracking image may be the frame itself
+  if (drawOverlays) {
+    for (const auto& slot : slots) {
+      if (slot.active) {
+        drawTrack(slot, Image);
       }
     }
-    // Create new tracker if detection is new
-    if (isNewDetection) {
-      cv::Ptr<cv::Tracker> tracker = cv::TrackerKCF::create();
-      tracker->init(Image, det);
-      trackers.push_back(tracker);
+  }
+}
+
+/**
+ * @brief Returns a free track slot.
+ * @return A slot that is not active; the pool grows by one if none is free.
+ */
+TrackSlot& Tracker::acquireSlot() {
+  // Slots before the hint were live at the last call, so new tracks of a
+  // crowded frame do not rescan the whole pool
+  for (; free_slot_hint < slots.size(); ++free_slot_hint) {
+    if (!slots[free_slot_hint].active) {
+      return slots[free_slot_hint++];
     }
   }
+  free_slot_hint = slots.size() + 1;
+  slots.emplace_back();
+  slots.back().tracker = cv::TrackerKCF::create();
+  return slots.back();
+}
+
+/**
+ * @brief Draws a track's box and estimated 3D position.
+ * @param slot Live track to draw.
+ * @param Image Frame to draw on.
+ */
+void Tracker::drawTrack(const TrackSlot& slot, const cv::Mat& Image) {
+  cv::rectangle(Image, slot.box, cv::Scalar(255, 255, 0), 2);
+  cv::Point3f location = getLocation(slot.box);
+  char label[96];
+  std::snprintf(label, sizeof(label), "Tracked: (%f, %f, %f)", location.x,
+                location.y, location.z);
+  overlayText.assign(label);
+  cv::putText(Image, overlayText, cv::Point(slot.box.x, slot.box.y - 10),
+              cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
 }
 
 /**
@@ -108,13 +212,14 @@ float Tracker::radians_to_degrees(float radians) {
  * @return 3D coordinates (x, y, z) of the object in the scene.
  */
 cv::Point3f Tracker::getLocation(const cv::Rect& detection) {
+  TraceScope scope("localization");
   cv::Point2f current_pixel;
   current_pixel.x = detection.x + static_cast<double>(detection.width) / 2;
   current_pixel.y = detection.y + static_cast<double>(detection.height) / 2;
 
   cv::Point3f coordinates;
 
-  std::vector<int> _resolution = {1280, 720};
+  const int _resolution[2] = {1280, 720};
   const float pixel_size = 0.0028;
   const float _height = 0.962;
   const float _focal_length = 1.898;
@@ -126,8 +231,6 @@ cv::Point3f Tracker::getLocation(const cv::Rect& detection) {
   float dip_angle = (_vfov / 2) - radians_to_degrees(std::atan2(
                                       (offset_from_center), (_focal_length)));
 
-  std :: cout << dip_angle;
-
   float z_min_plane =(_height * 10)/ tan(degrees_to_radians((_vfov / 2) + dip_angle)) ;
 
   float x_from_center = (current_pixel.x - 640) * 2.8;
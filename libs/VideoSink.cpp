@@ -0,0 +1,194 @@
+/**
+ * @file VideoSink.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the VideoSink class.
+ * @version 0.1
+ * @date 2024-11-22
+ */
+
+#include "VideoSink.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "Tracing.hpp"
+
+/**
+ * @brief Collects the live tracks of a tracker.
+ * @param tracker Tracker after its Track call for the frame.
+ * @param tracks Filled with the tracks and their estimated positions.
+ */
+void annotatedTracks(Tracker& tracker, std::vector<AnnotatedTrack>& tracks) {
+  tracks.clear();
+  for (const auto& slot : tracker.getTrackSlots()) {
+    if (slot.active) {
+      tracks.push_back({slot.id, slot.box, tracker.getLocation(slot.box)});
+    }
+  }
+}
+
+/**
+ * @brief Constructor for the VideoSink class.
+ * @param config Output file, encoder, queue and frame selection.
+ */
+VideoSink::VideoSink(const VideoSinkConfig& config) : config(config) {
+  if (config.path.empty() || config.queueDepth == 0 || config.everyNth == 0) {
+    throw std::invalid_argument(
+        "VideoSink needs a path, queueDepth >= 1 and everyNth >= 1");
+  }
+  worker = std::thread(&VideoSink::run, this);
+}
+
+VideoSink::~VideoSink() { close(); }
+
+/**
+ * @brief Copies a frame into the queue unless it is filtered or dropped.
+ *
+ * The copy goes into a slot of the sink's frame pool, which has the size
+ * and type of the first kept frame; frames of another size are resized
+ * into the slot.
+ * @param frame Frame to write.
+ * @param tracks Tracks of the frame.
+ * @return Whether the frame was queued.
+ */
+bool VideoSink::submit(const cv::Mat& frame,
+                       const std::vector<AnnotatedTrack>& tracks) {
+  if (frame.empty() || openFailed) {
+    return false;
+  }
+  if (submitted++ % config.everyNth != 0 ||
+      (config.onlyWithPeople && tracks.empty())) {
+    ++filtered;
+    return false;
+  }
+
+  std::vector<AnnotatedTrack> copiedTracks;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+      return false;
+    }
+    if (queue.size() >= config.queueDepth) {
+      ++dropped;
+      if (config.dropPolicy == SinkDropPolicy::kDropNewest) {
+        return false;
+      }
+      spareTracks.push_back(std::move(queue.front().tracks));
+      queue.pop_front();
+    }
+    if (!spareTracks.empty()) {
+      copiedTracks = std::move(spareTracks.back());
+      spareTracks.pop_back();
+    }
+  }
+
+  // One slot per queued frame plus the one being encoded, so a slot is
+  // always free once the queue has room
+  if (!pool) {
+    pool = std::make_unique<FramePool>(config.queueDepth + 1, frame.size(),
+                                       frame.type());
+  }
+  FrameHandle copy = pool->tryAcquire();
+  if (!copy || frame.type() != copy.mat().type()) {
+    ++dropped;
+    std::lock_guard<std::mutex> lock(mutex);
+    spareTracks.push_back(std::move(copiedTracks));
+    return false;
+  }
+  // Writing into the slot's own buffer keeps its size and allocation
+  cv::Mat& slot = copy.mat();
+  if (frame.size() == slot.size()) {
+    frame.copyTo(slot);
+  } else {
+    cv::resize(frame, slot, slot.size());
+  }
+  copiedTracks.assign(tracks.begin(), tracks.end());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back({std::move(copy), std::move(copiedTracks)});
+  }
+  wake.notify_one();
+  return true;
+}
+
+/**
+ * @brief Drains the queue, stops the writer thread and closes the file.
+ */
+void VideoSink::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Encodes queued frames until close() and the queue runs dry.
+ */
+void VideoSink::run() {
+  std::vector<AnnotatedTrack> tracks;
+  while (true) {
+    Item item;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      // The last frame's track buffer goes back to submit() for reuse
+      if (tracks.capacity() > 0) {
+        spareTracks.push_back(std::move(tracks));
+      }
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        break;
+      }
+      item = std::move(queue.front());
+      queue.pop_front();
+    }
+    tracks.swap(item.tracks);
+    if (openFailed) {
+      continue;
+    }
+
+    cv::Mat& frame = item.frame.mat();
+    if (!writer.isOpened()) {
+      videoSize = frame.size();
+      if (!writer.open(config.path, config.fourcc, config.fps, videoSize,
+                       frame.channels() > 1)) {
+        std::cerr << "Could not open video file " << config.path << std::endl;
+        openFailed = true;
+        continue;
+      }
+    }
+
+    TraceScope scope("encode");
+    if (config.drawOverlays) {
+      drawOverlays(frame, tracks);
+    }
+    writer.write(frame);
+    ++written;
+  }
+  writer.release();
+}
+
+/**
+ * @brief Draws the box, id and estimated position of every track.
+ * @param frame Frame to draw on.
+ * @param tracks Tracks of the frame.
+ */
+void VideoSink::drawOverlays(cv::Mat& frame,
+                             const std::vector<AnnotatedTrack>& tracks) {
+  for (const auto& track : tracks) {
+    cv::rectangle(frame, track.box, cv::Scalar(255, 255, 0), 2);
+    char label[96];
+    std::snprintf(label, sizeof(label), "Track %d: (%.2f, %.2f, %.2f)",
+                  track.id, track.position.x, track.position.y,
+                  track.position.z);
+    overlayText.assign(label);
+    cv::putText(frame, overlayText, cv::Point(track.box.x, track.box.y - 10),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
+  }
+}
@@ -0,0 +1,323 @@
+/**
+ * @file YoloDetector.cpp
+ * @author Sachin Jadhav (sjd3333@umd.edu)
+ * @brief Implementation of the YoloDetector class template and its explicit
+ * instantiations.
+ * @version 0.1
+ * @date 2024-11-13
+ */
+
+#include "YoloDetector.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "NonMaxSuppression.hpp"
+#include "Tracing.hpp"
+
+/**
+ * @brief Constructor for the YoloDetector class.
+ * @param modelPath Path to the pre-trained model file.
+ * @param configPath Path to the model configuration file.
+ * @param classesPath Path to the file containing class names.
+ * @param filter Class filter policy instance.
+ * @param thresholds Threshold policy instance.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::YoloDetector(
+    const std::string& modelPath, const std::string& configPath,
+    const std::string& classesPath, ClassFilter filter, Thresholds thresholds)
+    : loadModel(modelPath, configPath, classesPath),
+      filter(std::move(filter)),
+      thresholds(thresholds),
+      engine(std::make_shared<OpenCvDnnEngine>(net)) {
+  boxes.clear();
+  confidences.clear();
+}
+
+/**
+ * @brief Replaces the inference backend.
+ * @param newEngine Engine for all later forward passes.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+void YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::setEngine(
+    std::shared_ptr<InferenceEngine> newEngine) {
+  if (!newEngine) {
+    throw std::invalid_argument("YoloDetector needs an inference engine");
+  }
+  engine = std::move(newEngine);
+}
+
+/**
+ * @brief Starts profiling the network's layers.
+ * @param frames Forward passes to profile, 0 for all.
+ * @return The new profiler.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+LayerProfiler&
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::profileLayers(
+    size_t frames) {
+  layerProfiler = std::make_unique<LayerProfiler>(frames);
+  return *layerProfiler;
+}
+
+/**
+ * @brief Adds the last forward pass to the layer profile when profiling an
+ * engine that runs an OpenCV network.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+void YoloDetector<ClassFilter, BoxLayout, ScoreMode,
+                  Thresholds>::collectLayerTimings() {
+  if (!layerProfiler) {
+    return;
+  }
+  if (cv::dnn::Net* network = engine->network()) {
+    layerProfiler->collect(*network, blob);
+  }
+}
+
+/**
+ * @brief Detects objects of the filtered classes in the provided image.
+ *
+ * Runs the arena-based detection on the detector's own arena and copies the
+ * result out before resetting it.
+ *
+ * @param Image The image frame to process.
+ * @return A vector of cv::Rect objects, one per detection.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+std::vector<cv::Rect>
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::detect(
+    const cv::Mat& Image) {
+  std::vector<cv::Rect> detections;
+  {
+    std::pmr::vector<cv::Rect> kept = detect(Image, frameArena);
+    detections.assign(kept.begin(), kept.end());
+  }
+  frameArena.reset();
+  return detections;
+}
+
+/**
+ * @brief Detects objects of the filtered classes into per-frame storage.
+ *
+ * Converts the image into the reused blob, forwards it through the
+ * inference engine and post-processes the outputs in the arena.
+ *
+ * @param Image The image frame to process.
+ * @param arena Per-frame arena for the result and scratch data.
+ * @return Detections allocated in the arena.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+std::pmr::vector<cv::Rect>
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::detect(
+    const cv::Mat& Image, FrameArena& arena) {
+  {
+    TraceScope scope("preprocess");
+    // Convert image to blob for DNN input, reusing last frame's buffer
+    cv::dnn::blobFromImage(Image, blob, 1 / 255.0, cv::Size(416, 416),
+                           cv::Scalar(0, 0, 0), true, false);
+  }
+
+  {
+    TraceScope scope("forward");
+    engine->forward(blob, outs);
+  }
+  collectLayerTimings();
+
+  return postprocess(outs, Image.size(), arena);
+}
+
+/**
+ * @brief Decodes the network outputs and applies non-maximum suppression.
+ *
+ * Candidates, NMS scratch and the result all live in the arena; only the
+ * copies kept in boxes and confidences outlive the frame.
+ *
+ * @param outs Outputs of the forward pass.
+ * @param frameSize Size of the processed frame.
+ * @param arena Per-frame arena for the result and scratch data.
+ * @return Detections allocated in the arena.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+std::pmr::vector<cv::Rect>
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::postprocess(
+    const std::vector<cv::Mat>& outs, const cv::Size& frameSize,
+    FrameArena& arena) {
+  bindClasses();
+
+  // Process each output to find detections
+  const cv::Rect frame(0, 0, frameSize.width, frameSize.height);
+  std::pmr::vector<cv::Rect> candidates(&arena);
+  std::pmr::vector<float> scores(&arena);
+  {
+    TraceScope scope("decode");
+    for (const auto& out : outs) {
+      decode(out, frame, thresholds.confidence(), candidates, scores);
+    }
+  }
+
+  // Perform Non-Maximum Suppression to filter overlapping boxes
+  std::pmr::vector<int> indices(&arena);
+  {
+    TraceScope scope("nms");
+    nmsBoxes(candidates, scores, thresholds.score(), thresholds.nms(),
+             indices);
+  }
+
+  // Gather final detections after suppression
+  std::pmr::vector<cv::Rect> detections(&arena);
+  detections.reserve(indices.size());
+  for (int idx : indices) {
+    detections.push_back(candidates[idx]);
+  }
+
+  boxes.assign(candidates.begin(), candidates.end());
+  confidences.assign(scores.begin(), scores.end());
+  return detections;
+}
+
+/**
+ * @brief Detects on overlapping native-resolution tiles.
+ *
+ * Tiles are cut from the frame as ROI views, packed into a single batch blob
+ * and forwarded once. Each batch item of each YOLO output is decoded into
+ * frame coordinates through the tile it came from, then the per-tile boxes
+ * are merged with cross-tile NMS.
+ *
+ * @param Image The image frame to process.
+ * @param config Tile layout and merge thresholds.
+ * @return A vector of cv::Rect objects, one per detection.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+std::vector<cv::Rect>
+YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::detectTiled(
+    const cv::Mat& Image, const TilingConfig& config) {
+  bindClasses();
+  std::vector<cv::Rect> tiles = computeTiles(Image.size(), config);
+
+  std::vector<cv::Mat> inputs;
+  inputs.reserve(tiles.size() + 1);
+  for (const auto& tile : tiles) {
+    inputs.push_back(Image(tile));
+  }
+  if (config.includeFullFrame && tiles.size() > 1) {
+    tiles.emplace_back(0, 0, Image.cols, Image.rows);
+    inputs.push_back(Image);
+  }
+
+  {
+    TraceScope scope("preprocess");
+    cv::dnn::blobFromImages(inputs, blob, 1 / 255.0, cv::Size(416, 416),
+                            cv::Scalar(0, 0, 0), true, false);
+  }
+
+  {
+    TraceScope scope("forward");
+    engine->forward(blob, outs);
+  }
+  collectLayerTimings();
+
+  const int batchSize = static_cast<int>(tiles.size());
+  std::vector<TileDetection> detections;
+  {
+    TraceScope scope("decode");
+    std::pmr::vector<cv::Rect> tileBoxes;
+    std::pmr::vector<float> tileConfidences;
+    for (int item = 0; item < batchSize; ++item) {
+      tileBoxes.clear();
+      tileConfidences.clear();
+      for (const auto& out : outs) {
+        // Batched region layers return [batch, rows, cols]; older OpenCV
+        // releases stack the batch items along the rows instead
+        cv::Mat itemOut;
+        if (out.dims == 3) {
+          itemOut = cv::Mat(out.size[1], out.size[2], CV_32F,
+                            const_cast<float*>(out.ptr<float>(item)));
+        } else {
+          int rowsPerItem = out.rows / batchSize;
+          itemOut = out.rowRange(item * rowsPerItem, (item + 1) * rowsPerItem);
+        }
+        decode(itemOut, tiles[item], config.confidenceThreshold, tileBoxes,
+               tileConfidences);
+      }
+      for (size_t i = 0; i < tileBoxes.size(); ++i) {
+        detections.push_back({tileBoxes[i], tileConfidences[i], tiles[item]});
+      }
+    }
+  }
+
+  std::vector<cv::Rect> merged;
+  {
+    TraceScope scope("nms");
+    merged = mergeTileDetections(detections, Image.size(), config);
+  }
+  return merged;
+}
+
+/**
+ * @brief Decodes detections from one YOLO output matrix.
+ *
+ * The loop walks raw row pointers. Objectness is checked first because no
+ * class score can exceed it; only surviving rows reach the class filter, the
+ * score policy and the box layout, all of which inline.
+ *
+ * @param out Output rows of (box, objectness, class scores...).
+ * @param region Area of the frame that was fed to the network.
+ * @param threshold Minimum score for a row to be kept.
+ * @param outBoxes Receives boxes in frame coordinates.
+ * @param outConfidences Receives the matching scores.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+void YoloDetector<ClassFilter, BoxLayout, ScoreMode, Thresholds>::decode(
+    const cv::Mat& out, const cv::Rect& region, float threshold,
+    std::pmr::vector<cv::Rect>& outBoxes,
+    std::pmr::vector<float>& outConfidences) const {
+  const int numClasses = out.cols - 5;
+  for (int i = 0; i < out.rows; ++i) {
+    const float* row = out.ptr<float>(i);
+    const float objectness = row[4];
+    if (objectness <= threshold) {
+      continue;
+    }
+
+    int classId;
+    float classScore;
+    if (!filter.select(row + 5, numClasses, classId, classScore)) {
+      continue;
+    }
+    float score = ScoreMode::score(objectness, classScore);
+    if (score <= threshold) {
+      continue;
+    }
+
+    outBoxes.push_back(BoxLayout::toRect(row, region));
+    outConfidences.push_back(score);
+  }
+}
+
+/**
+ * @brief Resolves the class filter against the loaded labels if needed.
+ */
+template <class ClassFilter, class BoxLayout, class ScoreMode,
+          class Thresholds>
+void YoloDetector<ClassFilter, BoxLayout, ScoreMode,
+                  Thresholds>::bindClasses() {
+  if (!filter.bound()) {
+    filter.bind(classLabels);
+  }
+}
+
+template class YoloDetector<PersonOnly, CenterSizeBoxes, ClassScore,
+                            PersonThresholds>;
+template class YoloDetector<ClassSet, CenterSizeBoxes, ClassScore,
+                            RuntimeThresholds>;
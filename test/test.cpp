@@ -10,16 +10,73 @@
  */
 
 #include <gmock/gmock.h>
+#include <fcntl.h>
 #include <gtest/gtest.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include <atomic>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <memory_resource>
+#include <new>
 #include <opencv2/opencv.hpp>
+#include <optional>
 
+#include "../include/AsyncDetector.hpp"
+#include "../include/Detector.hpp"
+#include "../include/FrameArena.hpp"
+#include "../include/FrameCache.hpp"
+#include "../include/FrameCapture.hpp"
+#include "../include/FramePool.hpp"
+#include "../include/InferenceEngine.hpp"
+#include "../include/LatencyStats.hpp"
+#include "../include/LayerProfiler.hpp"
+#include "../include/MotionGate.hpp"
+#include "../include/NonMaxSuppression.hpp"
+#include "../include/ReplayHarness.hpp"
+#include "../include/Scheduling.hpp"
+#include "../include/SpatialGrid.hpp"
+#include "../include/TiledDetection.hpp"
+#include "../include/Tracing.hpp"
+#include "../include/TrackPublisher.hpp"
+#include "../include/TrackRing.hpp"
 #include "../include/Tracker.hpp"
+#include "../include/VideoSink.hpp"
 #include "../include/detectHuman.hpp"
 #include "../include/loadModel.hpp"
 
+namespace {
+
+/// Whether the replaced operator new counts allocations
+std::atomic<bool> countAllocations{false};
+/// Heap allocations made while counting was on
+std::atomic<size_t> allocationCount{0};
+
+}  // namespace
+
+/**
+ * @brief Test-only allocation hook: counts heap allocations while
+ * countAllocations is set.
+ */
+void* operator new(std::size_t size) {
+  if (countAllocations) {
+    ++allocationCount;
+  }
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
 /// Screen resolution used in tests
 std::vector<int> _resolution = {1280, 720};
 
@@ -279,3 +336,1226 @@ TEST_F(TrackerTest, GetLocationTest) {
   EXPECT_FALSE(std::isinf(location.y));
   EXPECT_FALSE(std::isinf(location.z));
 }
+
+/**
+ * @test TileLayoutCoversFrame
+ * @brief Verifies that the tile grid covers a 1280x720 frame with the
+ * requested overlap and keeps tiles inside the frame.
+ */
+TEST(TiledDetectionTest, TileLayoutCoversFrame) {
+  TilingConfig config;
+  config.tileWidth = 416;
+  config.tileHeight = 416;
+  config.overlap = 96;
+  std::vector<cv::Rect> tiles = computeTiles(cv::Size(1280, 720), config);
+
+  // Four columns (0, 320, 640, 864) and two rows (0, 304)
+  ASSERT_EQ(tiles.size(), 8u);
+  cv::Rect frame(0, 0, 1280, 720);
+  cv::Rect covered;
+  for (const auto& tile : tiles) {
+    EXPECT_EQ((tile & frame), tile) << "Tile leaves the frame";
+    covered |= tile;
+  }
+  EXPECT_EQ(covered, frame);
+  EXPECT_EQ(tiles[1].x - tiles[0].x, 416 - 96);
+
+  config.overlap = 416;
+  EXPECT_THROW(computeTiles(cv::Size(1280, 720), config),
+               std::invalid_argument);
+}
+
+/**
+ * @test MergeAcrossSeam
+ * @brief Checks that a person cut at a tile seam is merged into one box while
+ * separate people in different tiles are kept apart.
+ */
+TEST(TiledDetectionTest, MergeAcrossSeam) {
+  TilingConfig config;
+  cv::Size frame(832, 416);
+  cv::Rect left(0, 0, 416, 416);
+  cv::Rect right(320, 0, 416, 416);
+
+  std::vector<TileDetection> detections = {
+      // One person straddling the seam at x = 416, seen partly by each tile
+      {cv::Rect(380, 100, 36, 120), 0.9f, left},
+      {cv::Rect(380, 100, 60, 120), 0.8f, right},
+      // A second person well inside the right tile
+      {cv::Rect(600, 150, 40, 100), 0.95f, right},
+      // Below the score threshold, must be dropped
+      {cv::Rect(50, 50, 40, 100), 0.6f, left}};
+
+  std::vector<cv::Rect> merged = mergeTileDetections(detections, frame, config);
+  ASSERT_EQ(merged.size(), 2u);
+  EXPECT_EQ(merged[0], cv::Rect(600, 150, 40, 100));
+  EXPECT_EQ(merged[1], cv::Rect(380, 100, 60, 120));
+}
+
+/**
+ * @test MotionGateSkipsStaticScene
+ * @brief Checks that the gate skips unchanged frames, honours the forced
+ * refresh interval and reports the skip rate.
+ */
+TEST(MotionGateTest, MotionGateSkipsStaticScene) {
+  MotionGateConfig config;
+  config.refreshInterval = 5;
+  MotionGate gate(config);
+  cv::Mat frame(720, 1280, CV_8UC3, cv::Scalar(40, 80, 120));
+
+  // First frame has no reference, the next four are static
+  EXPECT_TRUE(gate.shouldDetect(frame));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(gate.shouldDetect(frame)) << "Static frame " << i;
+  }
+  // Forced refresh on the fifth frame since the last detection
+  EXPECT_TRUE(gate.shouldDetect(frame));
+  EXPECT_EQ(gate.framesSeen(), 6);
+  EXPECT_EQ(gate.framesSkipped(), 4);
+  EXPECT_NEAR(gate.skipRate(), 4.0 / 6.0, 1e-9);
+
+  // A person-sized bright block entering the scene counts as motion
+  cv::Mat moved = frame.clone();
+  cv::rectangle(moved, cv::Rect(600, 200, 80, 200), cv::Scalar(255, 255, 255),
+                cv::FILLED);
+  EXPECT_TRUE(gate.shouldDetect(moved));
+  EXPECT_GT(gate.lastChangedFraction(), config.changedFraction);
+  EXPECT_FALSE(gate.shouldDetect(moved));
+}
+
+/**
+ * @test FramePoolHandlesShareSlots
+ * @brief Checks that handles share slots by reference count, that slots
+ * return to the pool only when the last handle is dropped, and that an
+ * exhausted pool bounds memory instead of allocating.
+ */
+TEST(FramePoolTest, FramePoolHandlesShareSlots) {
+  FramePool pool(2, cv::Size(64, 48), CV_8UC3);
+  EXPECT_EQ(pool.available(), 2u);
+
+  FrameHandle first = pool.tryAcquire();
+  ASSERT_TRUE(first);
+  FrameHandle borrowed = first;  // Second stage borrows the same slot
+  EXPECT_EQ(borrowed.mat().data, first.mat().data);
+  EXPECT_EQ(pool.available(), 1u);
+
+  FrameHandle second = pool.tryAcquire();
+  ASSERT_TRUE(second);
+  EXPECT_FALSE(pool.tryAcquire()) << "Pool must not grow past its capacity";
+
+  first.reset();
+  EXPECT_EQ(pool.available(), 0u) << "Slot still borrowed";
+  borrowed.reset();
+  EXPECT_EQ(pool.available(), 1u);
+
+  // A frame of another size reallocates the slot, which is counted
+  second.mat().create(cv::Size(32, 32), CV_8UC3);
+  second.reset();
+  EXPECT_EQ(pool.allocations(), 1u);
+  EXPECT_EQ(pool.copies(), 0u);
+}
+
+/**
+ * @test CaptureWithoutCopiesOrAllocations
+ * @brief Runs the capture thread through two downstream stages and counts
+ * copies and buffer allocations per frame, which must both be zero.
+ */
+TEST(FramePoolTest, CaptureWithoutCopiesOrAllocations) {
+  const int kFrames = 100;
+  FramePool pool(3, cv::Size(64, 48), CV_8UC3);
+  std::vector<const uchar*> buffers;
+  {
+    std::vector<FrameHandle> slots;
+    for (size_t i = 0; i < pool.capacity(); ++i) {
+      slots.push_back(pool.tryAcquire());
+      buffers.push_back(slots.back().mat().data);
+    }
+  }
+
+  int produced = 0;
+  FrameCapture capture(pool, [&produced](cv::Mat& slot) {
+    if (produced == kFrames) {
+      return false;
+    }
+    slot.setTo(cv::Scalar::all(produced++ % 256));  // Decode in place
+    return true;
+  });
+  capture.start();
+
+  int consumed = 0;
+  while (FrameHandle frame = capture.next()) {
+    FrameHandle stage = frame;  // Hand the frame on to the next stage
+    EXPECT_NE(std::find(buffers.begin(), buffers.end(), stage.mat().data),
+              buffers.end())
+        << "Frame " << consumed << " does not live in a pool slot";
+    EXPECT_EQ(static_cast<int>(stage.mat().at<cv::Vec3b>(0, 0)[0]),
+              consumed % 256)
+        << "Frames out of order";
+    ++consumed;
+  }
+  capture.stop();
+
+  EXPECT_EQ(consumed, kFrames);
+  EXPECT_EQ(capture.framesCaptured(), static_cast<size_t>(kFrames));
+  EXPECT_EQ(pool.allocations(), 0u) << "Allocations per frame must be zero";
+  EXPECT_EQ(pool.copies(), 0u) << "Copies per frame must be zero";
+  EXPECT_EQ(pool.available(), pool.capacity());
+}
+
+/**
+ * @test LatestFrameWins
+ * @brief Checks that in latest-frame mode a slow consumer gets the freshest
+ * frame, stale frames are counted as dropped and frames carry increasing
+ * sequence numbers and capture times.
+ */
+TEST(FramePoolTest, LatestFrameWins) {
+  const int kFrames = 50;
+  FramePool pool(4, cv::Size(32, 24), CV_8UC3);
+  int produced = 0;
+  FrameCapture capture(
+      pool,
+      [&produced](cv::Mat& slot) {
+        if (produced == kFrames) {
+          return false;
+        }
+        slot.setTo(cv::Scalar::all(produced++));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return true;
+      },
+      1, CapturePolicy::kLatestFrame);
+  capture.start();
+
+  int delivered = 0;
+  uint64_t lastSequence = 0;
+  auto lastTime = std::chrono::steady_clock::time_point::min();
+  while (FrameHandle frame = capture.next()) {
+    if (delivered > 0) {
+      EXPECT_GT(frame.sequence(), lastSequence);
+    }
+    EXPECT_GE(frame.captureTime(), lastTime);
+    EXPECT_EQ(static_cast<uint64_t>(frame.mat().at<cv::Vec3b>(0, 0)[0]),
+              frame.sequence());
+    lastSequence = frame.sequence();
+    lastTime = frame.captureTime();
+    ++delivered;
+    // Consumer is five times slower than the camera
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  capture.stop();
+
+  EXPECT_EQ(capture.framesCaptured(), static_cast<size_t>(kFrames));
+  EXPECT_GT(capture.framesDropped(), 0u);
+  EXPECT_EQ(delivered + capture.framesDropped(), static_cast<size_t>(kFrames));
+  EXPECT_EQ(lastSequence, static_cast<uint64_t>(kFrames - 1))
+      << "The newest frame must be delivered last";
+}
+
+/**
+ * @test LatencyPercentiles
+ * @brief Checks nearest-rank percentiles over the sample window.
+ */
+TEST(LatencyStatsTest, LatencyPercentiles) {
+  LatencyStats stats(100);
+  EXPECT_EQ(stats.percentile(50), 0.0);
+  for (int ms = 1; ms <= 100; ++ms) {
+    stats.record(std::chrono::milliseconds(ms));
+  }
+  EXPECT_NEAR(stats.percentile(50), 50.0, 1e-6);
+  EXPECT_NEAR(stats.percentile(99), 99.0, 1e-6);
+  EXPECT_NEAR(stats.percentile(100), 100.0, 1e-6);
+
+  // Older samples leave the window
+  for (int i = 0; i < 100; ++i) {
+    stats.record(std::chrono::milliseconds(500));
+  }
+  EXPECT_EQ(stats.count(), 200u);
+  EXPECT_NEAR(stats.percentile(1), 500.0, 1e-6);
+}
+
+/**
+ * @test PolicyDecode
+ * @brief Decodes a hand-made YOLO output with the person-only and the
+ * runtime-configured detector and checks box geometry and class filtering.
+ */
+TEST(YoloDetectorTest, PolicyDecode) {
+  // Rows: person, dog, low-objectness person; four classes
+  cv::Mat out(3, 9, CV_32F, cv::Scalar(0));
+  const float rows[3][9] = {{0.5f, 0.5f, 0.1f, 0.4f, 0.9f, 0.85f, 0, 0, 0},
+                            {0.2f, 0.2f, 0.1f, 0.1f, 0.9f, 0, 0, 0, 0.8f},
+                            {0.7f, 0.7f, 0.1f, 0.2f, 0.3f, 0.3f, 0, 0, 0}};
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 9; ++c) {
+      out.at<float>(r, c) = rows[r][c];
+    }
+  }
+  const cv::Rect frame(0, 0, 1000, 500);
+
+  detectHuman personOnly("", "", "");
+  std::pmr::vector<cv::Rect> boxes;
+  std::pmr::vector<float> scores;
+  personOnly.decode(out, frame, 0.5f, boxes, scores);
+  ASSERT_EQ(boxes.size(), 1u);
+  EXPECT_EQ(boxes[0], cv::Rect(450, 150, 100, 200));
+  EXPECT_FLOAT_EQ(scores[0], 0.85f);
+
+  Detector generic("", "", "", {"dog"});
+  generic.classLabels = {"person", "bicycle", "car", "dog"};
+  generic.bindClasses();
+  boxes.clear();
+  scores.clear();
+  generic.decode(out, frame, 0.5f, boxes, scores);
+  ASSERT_EQ(boxes.size(), 1u);
+  EXPECT_EQ(boxes[0], cv::Rect(150, 75, 100, 50));
+
+  Detector unknown("", "", "", {"unicorn"});
+  unknown.classLabels = generic.classLabels;
+  EXPECT_THROW(unknown.bindClasses(), std::invalid_argument);
+}
+
+/**
+ * @test AsyncDetection
+ * @brief Checks that submitting never waits for a slow detector, that the
+ * in-flight bound cancels the stale request in favour of the newest one and
+ * that results arrive through both futures and callbacks.
+ */
+TEST(AsyncDetectorTest, AsyncDetection) {
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  std::atomic<bool> started{false};
+  AsyncDetectorConfig config;
+  config.maxInFlight = 2;
+  AsyncDetector detector(
+      [opened, &started](const cv::Mat& frame) {
+        started = true;
+        opened.wait();
+        int value = frame.at<uchar>(0, 0);
+        return std::vector<cv::Rect>{cv::Rect(value, value, 10, 10)};
+      },
+      config);
+
+  std::vector<cv::Mat> frames;
+  for (int i = 0; i < 3; ++i) {
+    frames.emplace_back(8, 8, CV_8UC1, cv::Scalar(i));
+  }
+
+  // The first request holds the executor until the gate opens
+  std::future<DetectionResult> first = detector.submit(frames[0]);
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  std::promise<DetectionResult> delivered;
+  std::future<DetectionResult> third = delivered.get_future();
+  auto start = std::chrono::steady_clock::now();
+  std::future<DetectionResult> second = detector.submit(frames[1]);
+  detector.submit(frames[2], [&delivered](const DetectionResult& result) {
+    delivered.set_value(result);
+  });
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(50))
+      << "Submitting must not wait for inference";
+
+  // Only one request fits behind the running one, so the newest frame
+  // displaced the stale one
+  ASSERT_EQ(second.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  EXPECT_TRUE(second.get().cancelled);
+  EXPECT_EQ(detector.inFlight(), 2u);
+
+  gate.set_value();
+  // Nothing counts as done before its result has been delivered
+  while (detector.inFlight() > 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(first.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  EXPECT_EQ(third.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  DetectionResult firstResult = first.get();
+  EXPECT_FALSE(firstResult.cancelled);
+  ASSERT_EQ(firstResult.detections.size(), 1u);
+  EXPECT_EQ(firstResult.detections[0], cv::Rect(0, 0, 10, 10));
+
+  DetectionResult thirdResult = third.get();
+  EXPECT_FALSE(thirdResult.cancelled);
+  ASSERT_EQ(thirdResult.detections.size(), 1u);
+  EXPECT_EQ(thirdResult.detections[0], cv::Rect(2, 2, 10, 10));
+  EXPECT_EQ(thirdResult.requestId, 2u);
+  EXPECT_EQ(detector.completedCount(), 2u);
+  EXPECT_EQ(detector.cancelledCount(), 1u);
+}
+
+/**
+ * @test SteadyStateAllocatesNothing
+ * @brief Runs the post-forward detection path (decode, NMS, result) on a
+ * synthetic YOLO output and checks that, after warm-up, frames are served
+ * entirely from the arena and reused buffers.
+ */
+TEST(FrameArenaTest, SteadyStateAllocatesNothing) {
+  // A crowd of people, each reported by several overlapping rows
+  cv::Mat out(300, 85, CV_32F, cv::Scalar(0));
+  for (int r = 0; r < out.rows; ++r) {
+    float* row = out.ptr<float>(r);
+    int person = r / 3;
+    row[0] = 0.05f + 0.009f * person;
+    row[1] = 0.5f + 0.002f * (r % 3);
+    row[2] = 0.02f;
+    row[3] = 0.1f;
+    row[4] = 0.9f;
+    row[5] = 0.75f + 0.05f * (r % 3);
+  }
+  const std::vector<cv::Mat> outs{out};
+
+  detectHuman detector("", "", "");
+  // Deliberately too small, so warm-up has to grow it
+  FrameArena arena(256);
+  size_t kept = 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    kept = detector.postprocess(outs, cv::Size(1280, 720), arena).size();
+    arena.reset();
+  }
+  const size_t warmCapacity = arena.capacity();
+
+  allocationCount = 0;
+  countAllocations = true;
+  for (int frame = 0; frame < 20; ++frame) {
+    kept = detector.postprocess(outs, cv::Size(1280, 720), arena).size();
+    arena.reset();
+  }
+  countAllocations = false;
+
+  EXPECT_EQ(allocationCount.load(), 0u);
+  EXPECT_EQ(kept, 100u) << "One detection per person after NMS";
+  EXPECT_EQ(arena.capacity(), warmCapacity);
+  EXPECT_GT(arena.spills(), 0u);
+  EXPECT_GE(arena.capacity(), arena.highWater());
+
+  // Same result as the OpenCV implementation
+  std::pmr::vector<int> indices(&arena);
+  std::pmr::vector<cv::Rect> boxes(detector.boxes.begin(),
+                                   detector.boxes.end(), &arena);
+  std::pmr::vector<float> scores(detector.confidences.begin(),
+                                 detector.confidences.end(), &arena);
+  nmsBoxes(boxes, scores, 0.7f, 0.4f, indices);
+  std::vector<int> reference;
+  cv::dnn::NMSBoxes(detector.boxes, detector.confidences, 0.7f, 0.4f,
+                    reference);
+  EXPECT_EQ(std::vector<int>(indices.begin(), indices.end()), reference);
+}
+
+/**
+ * @test TrackingAllocatesNothing
+ * @brief Drives a Tracker on a synthetic engine through whole frames
+ * (detection, frame cache, tracker updates, association) and checks that,
+ * after warm-up, Track makes no heap allocation.
+ */
+TEST(FrameArenaTest, TrackingAllocatesNothing) {
+  // A still scene, so every detection after the first frame matches a track
+  SyntheticSceneConfig scene;
+  scene.people = 5;
+  scene.speed = 0.0f;
+  auto engine = std::make_shared<SyntheticEngine>(scene);
+  cv::Mat frame(720, 1280, CV_8UC3, cv::Scalar::all(60));
+  engine->render(frame);
+
+  Tracker tracker("", "", "", cv::Mat());
+  tracker.setEngine(engine);
+  tracker.setDrawOverlays(false);
+  for (int warmup = 0; warmup < 5; ++warmup) {
+    tracker.Track(frame);
+  }
+  const size_t tracks = tracker.activeTrackCount();
+
+  allocationCount = 0;
+  countAllocations = true;
+  for (int f = 0; f < 20; ++f) {
+    tracker.Track(frame);
+  }
+  countAllocations = false;
+
+  EXPECT_EQ(allocationCount.load(), 0u) << "Track must not allocate";
+  EXPECT_GT(tracks, 0u);
+  EXPECT_EQ(tracker.activeTrackCount(), tracks);
+}
+
+/**
+ * @test RecordAndCompare
+ * @brief Round-trips a recorded sequence and golden tracks through disk and
+ * checks the tolerance of the track comparison.
+ */
+TEST(ReplayHarnessTest, RecordAndCompare) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "perception_replay_test";
+  std::filesystem::remove_all(directory);
+
+  const std::vector<std::vector<cv::Rect>> recorded = {
+      {cv::Rect(10, 20, 30, 60)},
+      {},
+      {cv::Rect(12, 21, 30, 60), cv::Rect(100, 50, 20, 40)}};
+  {
+    SequenceRecorder recorder(directory.string());
+    for (size_t i = 0; i < recorded.size(); ++i) {
+      recorder.record(cv::Mat(48, 64, CV_8UC3, cv::Scalar::all(10 * i)),
+                      recorded[i]);
+    }
+    EXPECT_EQ(recorder.framesRecorded(), recorded.size());
+  }
+
+  RecordedSequence sequence = RecordedSequence::load(directory.string());
+  ASSERT_EQ(sequence.frames.size(), recorded.size());
+  EXPECT_EQ(sequence.detections, recorded);
+  EXPECT_EQ(sequence.frames[2].at<cv::Vec3b>(0, 0)[0], 20);
+
+  const std::vector<FrameTracks> golden = {
+      {{0, cv::Rect(10, 20, 30, 60)}},
+      {{0, cv::Rect(11, 20, 30, 60)}},
+      {{0, cv::Rect(12, 21, 30, 60)}, {1, cv::Rect(100, 50, 20, 40)}}};
+  const std::string goldenPath = (directory / "golden.txt").string();
+  writeTracks(goldenPath, golden);
+  std::vector<FrameTracks> loaded = readTracks(goldenPath);
+  EXPECT_TRUE(compareTracks(loaded, golden, 0).empty());
+
+  std::vector<FrameTracks> drifted = golden;
+  drifted[1][0].box.x += 3;
+  EXPECT_EQ(compareTracks(drifted, golden, 2).size(), 1u);
+  EXPECT_TRUE(compareTracks(drifted, golden, 3).empty());
+
+  drifted[2].pop_back();
+  EXPECT_EQ(compareTracks(drifted, golden, 3).size(), 1u);
+
+  std::filesystem::remove_all(directory);
+}
+
+/**
+ * @test SyntheticEngineDrivesDetector
+ * @brief Runs the person detector on a synthetic engine: every scripted
+ * person is found at its ground-truth box (or merged by NMS into an
+ * overlapping one), the scene moves between frames and the simulated
+ * forward latency is honoured.
+ */
+TEST(InferenceEngineTest, SyntheticEngineDrivesDetector) {
+  SyntheticSceneConfig scene;
+  scene.people = 6;
+  scene.forwardLatency = std::chrono::milliseconds(5);
+  auto engine = std::make_shared<SyntheticEngine>(scene);
+
+  detectHuman detector("", "", "");
+  detector.setEngine(engine);
+  EXPECT_EQ(detector.getEngine().name(), "synthetic");
+
+  const cv::Mat frame(720, 1280, CV_8UC3, cv::Scalar::all(0));
+  std::vector<cv::Rect> previous;
+  for (int f = 0; f < 3; ++f) {
+    std::vector<cv::Rect> truth = engine->groundTruth(frame.size());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<cv::Rect> detections = detector.detectHumans(frame);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(5));
+
+    auto iou = [](const cv::Rect& a, const cv::Rect& b) {
+      double intersection = (a & b).area();
+      return intersection / (a.area() + b.area() - intersection);
+    };
+    for (const auto& det : detections) {
+      bool matched = false;
+      for (const auto& box : truth) {
+        matched |= iou(box, det) > 0.8;
+      }
+      EXPECT_TRUE(matched) << "Frame " << f << " has a phantom detection";
+    }
+    // A person may only be missing if NMS merged it into a neighbour
+    for (const auto& box : truth) {
+      bool explained = false;
+      for (const auto& det : detections) {
+        explained |= iou(box, det) > 0.4;
+      }
+      EXPECT_TRUE(explained) << "Frame " << f << " missed a scripted person";
+    }
+    EXPECT_GE(detections.size(), 1u);
+    EXPECT_NE(truth, previous);
+    previous = truth;
+  }
+  EXPECT_EQ(engine->framesEmitted(), 3u);
+
+  // A layout with exactly one row per report still emits every report
+  SyntheticSceneConfig packed;
+  packed.people = 50;
+  packed.outputRows = {packed.people * packed.rowsPerPerson};
+  SyntheticEngine full(packed);
+  std::vector<cv::Mat> outs;
+  for (int f = 0; f < 3; ++f) {
+    full.forward(cv::Mat(), outs);
+    int reports = 0;
+    for (int r = 0; r < outs[0].rows; ++r) {
+      reports += outs[0].ptr<float>(r)[4] > 0.5f ? 1 : 0;
+    }
+    EXPECT_EQ(reports, packed.people * packed.rowsPerPerson);
+  }
+  packed.outputRows = {packed.people * packed.rowsPerPerson - 1};
+  EXPECT_THROW(SyntheticEngine{packed}, std::invalid_argument);
+}
+
+/**
+ * @test BudgetsPinningAndAccounting
+ * @brief Parses schedule specs, pins a registered thread to its
+ * component's core and checks the per-component CPU accounting, including
+ * threads that exit without leaving and schedulers reusing an address.
+ */
+TEST(SchedulingTest, BudgetsPinningAndAccounting) {
+  SchedulingConfig parsed =
+      SchedulingConfig::parse("inference=0-2+5@3,tracking=4,render=4+6");
+  EXPECT_EQ(parsed.cores[static_cast<int>(Component::kInference)],
+            std::vector<int>({0, 1, 2, 5}));
+  EXPECT_EQ(parsed.cores[static_cast<int>(Component::kTracking)],
+            std::vector<int>({4}));
+  EXPECT_TRUE(parsed.cores[static_cast<int>(Component::kCapture)].empty());
+  EXPECT_EQ(parsed.inferenceThreads, 3);
+  EXPECT_THROW(SchedulingConfig::parse("decode=1"), std::invalid_argument);
+  EXPECT_THROW(SchedulingConfig::parse("tracking=1@2"), std::invalid_argument);
+  EXPECT_THROW(SchedulingConfig::parse("capture=3-1"), std::invalid_argument);
+  EXPECT_THROW(SchedulingConfig::parse("render=x"), std::invalid_argument);
+
+  // Pin tracking to the first core this process may use
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int core = 0;
+  while (!CPU_ISSET(core, &allowed)) {
+    ++core;
+  }
+  SchedulingConfig config;
+  config.cores[static_cast<int>(Component::kTracking)] = {core};
+  config.pin = true;
+  Scheduler scheduler(config);
+
+  std::atomic<int> ranOn{-1};
+  std::thread worker([&scheduler, &ranOn] {
+    scheduler.enter(Component::kTracking);
+    volatile double sink = 0.0;
+    auto until = std::chrono::steady_clock::now() +
+                 std::chrono::milliseconds(100);
+    while (std::chrono::steady_clock::now() < until) {
+      sink = sink + 1.0;
+    }
+    ranOn = sched_getcpu();
+    scheduler.leave();
+  });
+  worker.join();
+
+  EXPECT_EQ(ranOn.load(), core);
+  std::array<ComponentUsage, kComponentCount> usage = scheduler.usage();
+  const ComponentUsage& tracking =
+      usage[static_cast<int>(Component::kTracking)];
+  EXPECT_GT(tracking.cpuSeconds, 0.05);
+  EXPECT_EQ(tracking.coresBudgeted, 1u);
+  EXPECT_EQ(usage[static_cast<int>(Component::kInference)].cpuSeconds, 0.0);
+  EXPECT_NE(scheduler.report().find("tracking"), std::string::npos);
+
+  // A core the process cannot run on is rejected up front
+  SchedulingConfig unavailable;
+  unavailable.cores[static_cast<int>(Component::kCapture)] = {CPU_SETSIZE};
+  EXPECT_THROW(Scheduler bad(unavailable), std::invalid_argument);
+
+  // A thread left registered with a destroyed scheduler starts afresh with
+  // a new one, even at the same address
+  std::optional<Scheduler> reused;
+  reused.emplace(SchedulingConfig());
+  const Scheduler* first = &*reused;
+  reused->enter(Component::kRender);
+  reused.emplace(SchedulingConfig());
+  ASSERT_EQ(&*reused, first);
+  reused->enter(Component::kCapture);
+  reused->leave();
+  EXPECT_EQ(reused->usage()[static_cast<int>(Component::kRender)].cpuSeconds,
+            0.0);
+
+  // A thread that exits without leave() charges no negative time
+  Scheduler abandoned;
+  std::thread([&abandoned] {
+    volatile double sink = 0.0;
+    for (int i = 0; i < 1000000; ++i) {
+      sink = sink + i;
+    }
+    abandoned.enter(Component::kCapture);
+  }).join();
+  EXPECT_GE(abandoned.usage()[static_cast<int>(Component::kCapture)].cpuSeconds,
+            0.0);
+  EXPECT_GE(abandoned.unregisteredCpuSeconds(), 0.0);
+}
+
+/**
+ * @test ConsumerProcessReadsEveryFrame
+ * @brief Checks that a consumer process reads every published frame intact,
+ * that a slow subscriber skips ahead and that a frame left half-written
+ * does not hang its readers.
+ */
+TEST(TrackPublisherTest, ConsumerProcessReadsEveryFrame) {
+  const std::string name =
+      "/perception_test_tracks_" + std::to_string(getpid());
+  constexpr uint64_t kFrames = 300;
+  TrackPublisher publisher(name, 8);
+  EXPECT_THROW(TrackSubscriber("/perception_test_missing"), std::runtime_error);
+
+  // What the consumer process reports back through the pipe
+  struct ConsumerReport {
+    uint64_t frames = 0;
+    uint64_t lost = 0;
+    uint64_t corrupt = 0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+  };
+  int ready[2];
+  int results[2];
+  ASSERT_EQ(pipe(ready), 0);
+  ASSERT_EQ(pipe(results), 0);
+
+  pid_t consumer = fork();
+  ASSERT_GE(consumer, 0);
+  if (consumer == 0) {
+    close(ready[0]);
+    close(results[0]);
+    ConsumerReport report;
+    try {
+      TrackSubscriber subscriber(name);
+      char byte = 1;
+      if (write(ready[1], &byte, 1) != 1) {
+        _exit(1);
+      }
+      LatencyStats latency;
+      TrackFrame frame;
+      while (report.frames + subscriber.framesLost() < kFrames &&
+             subscriber.waitNext(frame, std::chrono::seconds(2))) {
+        latency.record(std::chrono::nanoseconds(sharedClockNanos() -
+                                                frame.published));
+        ++report.frames;
+        // Every frame carries frame % 5 tracks with ids derived from it
+        bool intact = frame.count == frame.frame % 5;
+        for (uint32_t i = 0; intact && i < frame.count; ++i) {
+          intact = frame.tracks[i].id == static_cast<int32_t>(frame.frame + i);
+        }
+        report.corrupt += intact ? 0 : 1;
+      }
+      report.lost = subscriber.framesLost();
+      report.p50 = latency.percentile(50);
+      report.p99 = latency.percentile(99);
+    } catch (const std::exception&) {
+    }
+    bool sent = write(results[1], &report, sizeof(report)) ==
+                static_cast<ssize_t>(sizeof(report));
+    _exit(sent ? 0 : 1);
+  }
+  // Only the consumer writes, so a consumer that dies ends the reads below
+  close(ready[1]);
+  close(results[1]);
+
+  char byte = 0;
+  ASSERT_EQ(read(ready[0], &byte, 1), 1) << "Consumer could not subscribe";
+  for (uint64_t f = 0; f < kFrames; ++f) {
+    TrackFrame& frame = publisher.beginFrame();
+    for (uint32_t i = 0; i < f % 5; ++i) {
+      SharedTrack& track = frame.tracks[frame.count++];
+      track.id = static_cast<int32_t>(f + i);
+      track.x = track.y = 10;
+      track.width = track.height = 20;
+    }
+    publisher.commit();
+    // A frame period far shorter than the camera's, but not a flood
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+
+  ConsumerReport report;
+  ASSERT_EQ(read(results[0], &report, sizeof(report)),
+            static_cast<ssize_t>(sizeof(report)));
+  int status = 0;
+  waitpid(consumer, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  close(ready[0]);
+  close(results[0]);
+
+  EXPECT_EQ(publisher.framesPublished(), kFrames);
+  EXPECT_EQ(report.frames + report.lost, kFrames);
+  EXPECT_GT(report.frames, 0u);
+  EXPECT_EQ(report.corrupt, 0u);
+  // Latency depends on the machine's load, so it is only reported
+  std::cout << "Consumer process latency p50 " << report.p50 << " ms, p99 "
+            << report.p99 << " ms" << std::endl;
+
+  // A subscriber that falls a ring length behind skips ahead and says so
+  TrackSubscriber slow(name);
+  for (int f = 0; f < 20; ++f) {
+    publisher.beginFrame();
+    publisher.commit();
+  }
+  TrackFrame frame;
+  EXPECT_EQ(slow.next(frame), ReadStatus::kLost);
+  EXPECT_EQ(frame.frame, kFrames + 20 - slow.slots() + 1);
+  EXPECT_EQ(slow.framesLost(), frame.frame - (kFrames - 1));
+  EXPECT_TRUE(slow.latest(frame));
+  EXPECT_EQ(frame.frame, kFrames + 19);
+  EXPECT_EQ(slow.next(frame), ReadStatus::kNoFrame);
+
+  // A publisher that dies mid-write leaves its slot's counter odd
+  TrackSubscriber stalled(name);
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  const size_t bytes = trackRingBytes(stalled.slots());
+  void* mapped =
+      mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(mapped, MAP_FAILED);
+  auto* ring = reinterpret_cast<TrackRingSlot*>(
+      static_cast<TrackRingHeader*>(mapped) + 1);
+  const uint64_t torn = kFrames + 19;
+  ring[torn % stalled.slots()].sequence.store(2 * torn + 1);
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(stalled.next(frame), ReadStatus::kStalled);
+  EXPECT_FALSE(stalled.waitNext(frame, std::chrono::milliseconds(20)));
+  EXPECT_FALSE(stalled.latest(frame));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  EXPECT_EQ(stalled.framesLost(), 0u);
+
+  // Once a newer frame is out, the half-written one is skipped as lost
+  publisher.beginFrame();
+  publisher.commit();
+  EXPECT_EQ(stalled.next(frame), ReadStatus::kLost);
+  EXPECT_EQ(frame.frame, kFrames + 20);
+  EXPECT_EQ(stalled.framesLost(), 1u);
+  munmap(mapped, bytes);
+}
+
+/**
+ * @test SelectsFramesAndNeverBlocks
+ * @brief Checks the sink's frame selection and drop accounting, that
+ * submitting never waits for the encoder and that frames of another size
+ * or type are resized or dropped.
+ */
+TEST(VideoSinkTest, SelectsFramesAndNeverBlocks) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "perception_video_sink_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  VideoSinkConfig config;
+  config.path = (directory / "annotated.avi").string();
+  config.queueDepth = 4;
+  config.everyNth = 2;
+  config.onlyWithPeople = true;
+  VideoSink sink(config);
+
+  cv::Mat frame(240, 320, CV_8UC3, cv::Scalar(30, 30, 30));
+  const std::vector<AnnotatedTrack> person = {
+      {7, cv::Rect(100, 60, 40, 100), cv::Point3f(1.0f, 0.2f, 0.0f)}};
+  auto slowest = std::chrono::steady_clock::duration::zero();
+  size_t queued = 0;
+  for (int f = 0; f < 40; ++f) {
+    // People in the first half of the run only
+    std::vector<AnnotatedTrack> tracks =
+        f < 20 ? person : std::vector<AnnotatedTrack>();
+    auto start = std::chrono::steady_clock::now();
+    queued += sink.submit(frame, tracks) ? 1 : 0;
+    slowest = std::max(slowest, std::chrono::steady_clock::now() - start);
+    // The caller reuses its buffer at once; the sink works on a copy
+    frame.setTo(cv::Scalar(f, f, f));
+  }
+  sink.close();
+  EXPECT_FALSE(sink.submit(frame, person)) << "Closed sinks take no frames";
+
+  // Every other frame, and of those only the ten with people; frames
+  // queued and then evicted by newer ones count as dropped
+  EXPECT_EQ(sink.framesFiltered(), 30u);
+  EXPECT_EQ(sink.framesWritten() + sink.framesDropped(), 10u);
+  EXPECT_LE(sink.framesWritten(), queued);
+  EXPECT_GT(sink.framesWritten(), 0u);
+  EXPECT_FALSE(sink.failed());
+  EXPECT_TRUE(std::filesystem::exists(config.path));
+  EXPECT_LT(slowest, std::chrono::milliseconds(20))
+      << "Submitting must not wait for the encoder";
+
+  // Later frames of another size are resized; another type is dropped
+  VideoSinkConfig mixed;
+  mixed.path = (directory / "mixed.avi").string();
+  mixed.queueDepth = 2;
+  mixed.dropPolicy = SinkDropPolicy::kDropNewest;
+  VideoSink resizing(mixed);
+  EXPECT_TRUE(resizing.submit(frame, person));
+  EXPECT_TRUE(resizing.submit(
+      cv::Mat(480, 640, CV_8UC3, cv::Scalar(90, 90, 90)), person));
+  EXPECT_FALSE(
+      resizing.submit(cv::Mat(240, 320, CV_8UC1, cv::Scalar(9)), person));
+  resizing.close();
+  EXPECT_EQ(resizing.framesDropped(), 1u);
+  EXPECT_EQ(resizing.framesWritten(), 2u);
+
+  // An unwritable path fails the sink instead of the caller
+  VideoSinkConfig broken;
+  broken.path = (directory / "missing" / "out.avi").string();
+  broken.dropPolicy = SinkDropPolicy::kDropNewest;
+  VideoSink failing(broken);
+  failing.submit(frame, person);
+  failing.close();
+  EXPECT_TRUE(failing.failed());
+  EXPECT_EQ(failing.framesWritten(), 0u);
+  EXPECT_THROW(VideoSink{VideoSinkConfig()}, std::invalid_argument);
+
+  std::filesystem::remove_all(directory);
+}
+
+/**
+ * @test FindsEveryOverlapOnce
+ * @brief Checks that grid queries visit every overlapping box exactly once
+ * and few others, and that grid association matches testing every pair.
+ */
+TEST(SpatialGridTest, FindsEveryOverlapOnce) {
+  cv::RNG rng(38);
+  std::vector<cv::Rect> boxes;
+  for (int i = 0; i < 300; ++i) {
+    // Some boxes hang off the top-left edge into negative cells
+    int width = rng.uniform(10, 120);
+    int height = rng.uniform(20, 200);
+    boxes.emplace_back(rng.uniform(-100, 1800), rng.uniform(-100, 1000), width,
+                       height);
+  }
+
+  SpatialGrid grid;
+  grid.reset(SpatialGrid::suggestCellSize(boxes), boxes.size());
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    grid.insert(static_cast<int>(i), boxes[i]);
+  }
+  EXPECT_EQ(grid.size(), boxes.size());
+
+  size_t candidates = 0;
+  for (int q = 0; q < 200; ++q) {
+    cv::Rect query(rng.uniform(-150, 1900), rng.uniform(-150, 1100),
+                   rng.uniform(1, 150), rng.uniform(1, 250));
+    std::vector<int> expected;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      if ((query & boxes[i]).area() > 0) {
+        expected.push_back(static_cast<int>(i));
+      }
+    }
+    std::vector<int> visited;
+    grid.query(query, [&](int id) {
+      visited.push_back(id);
+      return true;
+    });
+    candidates += visited.size();
+    std::vector<int> found;
+    for (int id : visited) {
+      if ((query & boxes[id]).area() > 0) {
+        found.push_back(id);
+      }
+    }
+    std::sort(visited.begin(), visited.end());
+    EXPECT_EQ(std::adjacent_find(visited.begin(), visited.end()),
+              visited.end())
+        << "Boxes spanning several cells are visited once";
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, expected);
+  }
+  // Only nearby boxes are candidates, not the whole set
+  EXPECT_LT(candidates, 200u * boxes.size() / 10);
+
+  // Stopping early visits nothing more
+  int calls = 0;
+  grid.query(cv::Rect(-200, -200, 2400, 1600), [&calls](int) {
+    ++calls;
+    return false;
+  });
+  EXPECT_EQ(calls, 1);
+
+  // Association starts a track for each detection that overlaps neither a
+  // track nor an earlier new track, like testing every pair
+  std::vector<cv::Rect> tracks(boxes.begin(), boxes.begin() + 150);
+  tracks[3] = cv::Rect();
+  std::vector<cv::Rect> detections(boxes.begin() + 100, boxes.end());
+  std::vector<cv::Rect> expected = tracks;
+  for (const auto& det : detections) {
+    bool isNew = true;
+    for (const auto& box : expected) {
+      isNew = isNew && (det & box).area() == 0;
+    }
+    if (isNew) {
+      expected.push_back(det);
+    }
+  }
+  std::vector<cv::Rect> started = tracks;
+  size_t count = grid.associate(
+      tracks.size(), [&started](int i) { return started[i]; }, detections,
+      [&started](const cv::Rect& det) {
+        started.push_back(det);
+        return static_cast<int>(started.size()) - 1;
+      });
+  EXPECT_EQ(count, expected.size() - tracks.size());
+  EXPECT_EQ(started, expected);
+
+  grid.reset(64, 0);
+  grid.query(boxes[0], [](int) {
+    ADD_FAILURE() << "A reset grid is empty";
+    return true;
+  });
+}
+
+/**
+ * @test RecordsScopesPerThreadAsChromeTrace
+ * @brief Checks that disabled scopes record nothing, that enabled ones are
+ * written per thread as a Chrome trace and that a full buffer keeps the
+ * latest events.
+ */
+TEST(TracingTest, RecordsScopesPerThreadAsChromeTrace) {
+  Tracing::setEnabled(false);
+  Tracing::clear();
+
+  // Disabled scopes record nothing and cost next to nothing
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000000; ++i) {
+    TraceScope scope("disabled");
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(100));
+  EXPECT_EQ(Tracing::eventCount(), 0u);
+
+  Tracing::setEnabled(true);
+  {
+    TraceScope frame("frame", 41);
+    TraceScope forward("forward");
+  }
+  std::thread worker([] {
+    Tracing::setThreadName("worker \"1\"");
+    for (int id = 0; id < 3; ++id) {
+      TraceScope scope("track update", id);
+    }
+  });
+  worker.join();
+  Tracing::setEnabled(false);
+  {
+    TraceScope ignored("after stop");
+  }
+  EXPECT_EQ(Tracing::eventCount(), 5u);
+  EXPECT_EQ(Tracing::droppedCount(), 0u);
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "perception_trace_test.json")
+          .string();
+  EXPECT_EQ(Tracing::writeChromeTrace(path), 5u);
+  std::ifstream file(path);
+  std::string json((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  auto occurrences = [&json](const std::string& needle) {
+    size_t found = 0;
+    for (size_t at = json.find(needle); at != std::string::npos;
+         at = json.find(needle, at + 1)) {
+      ++found;
+    }
+    return found;
+  };
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_EQ(occurrences("\"ph\":\"X\""), 5u);
+  EXPECT_EQ(occurrences("\"name\":\"track update\""), 3u);
+  EXPECT_EQ(occurrences("\"args\":{\"id\":41}"), 1u);
+  EXPECT_EQ(occurrences("\"name\":\"after stop\""), 0u);
+  EXPECT_EQ(occurrences(R"("args":{"name":"worker \"1\""})"), 1u)
+      << "Thread names are escaped";
+
+  // A full buffer keeps the latest events, so a long run is still traced
+  Tracing::setEnabled(true);
+  for (size_t i = 0; i < Tracing::kEventsPerThread + 10; ++i) {
+    TraceScope scope("wrap", static_cast<int64_t>(i));
+  }
+  Tracing::setEnabled(false);
+  // This thread's two earlier events and ten "wrap" events are overwritten
+  EXPECT_EQ(Tracing::eventCount(), Tracing::kEventsPerThread + 3);
+  EXPECT_EQ(Tracing::droppedCount(), 12u);
+  EXPECT_EQ(Tracing::writeChromeTrace(path), Tracing::eventCount());
+  file = std::ifstream(path);
+  json.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  EXPECT_EQ(occurrences("\"name\":\"frame\""), 0u);
+  EXPECT_EQ(occurrences("\"args\":{\"id\":9}"), 0u);
+  EXPECT_EQ(occurrences(
+                "\"args\":{\"id\":" +
+                std::to_string(Tracing::kEventsPerThread + 9) + "}"),
+            1u);
+
+  Tracing::clear();
+  EXPECT_EQ(Tracing::eventCount(), 0u);
+  std::filesystem::remove(path);
+}
+
+/**
+ * @test AggregatesLayersAndTypes
+ * @brief Checks that layer timings are averaged per layer and per type and
+ * reported as text and JSON.
+ */
+TEST(LayerProfilerTest, AggregatesLayersAndTypes) {
+  // Engines without an OpenCV network are not profiled
+  detectHuman detector("", "", "");
+  detector.setEngine(std::make_shared<SyntheticEngine>());
+  detector.profileLayers(2);
+  detector.detectHumans(cv::Mat(480, 640, CV_8UC3, cv::Scalar::all(0)));
+  EXPECT_EQ(detector.getLayerProfiler()->frames(), 0u);
+
+  LayerProfiler profiler(2);
+  EXPECT_EQ(profiler.textReport(), "No layer timings collected");
+  profiler.describe({1, 3, 416, 416},
+                    {{1, "conv_0", "Convolution", 4000, 1024, 2048},
+                     {2, "bn_0", "BatchNorm", 100, 64, 2048},
+                     {3, "conv_1", "Convolution", 9000, 4096, 1024},
+                     {4, "yolo_2", "Region", 0, 0, 512}});
+  profiler.addFrame({2.0, 0.5, 6.0, 0.0});
+  profiler.addFrame({4.0, 0.5, 6.0, 0.0});
+  EXPECT_THROW(profiler.addFrame({1.0}), std::invalid_argument);
+  EXPECT_EQ(profiler.frames(), 2u);
+  EXPECT_TRUE(profiler.done());
+  EXPECT_DOUBLE_EQ(profiler.totalMs(), 19.0);
+
+  std::vector<LayerCost> layers = profiler.byLayer();
+  ASSERT_EQ(layers.size(), 4u);
+  EXPECT_EQ(layers[0].name, "conv_1");
+  EXPECT_EQ(layers[1].name, "conv_0");
+  EXPECT_EQ(layers[2].name, "bn_0");
+  EXPECT_EQ(layers[3].name, "yolo_2") << "Fused layers report no time";
+
+  std::vector<LayerTypeCost> types = profiler.byType();
+  ASSERT_EQ(types.size(), 3u);
+  EXPECT_EQ(types[0].type, "Convolution");
+  EXPECT_EQ(types[0].layers, 2);
+  EXPECT_DOUBLE_EQ(types[0].totalMs, 18.0);
+  EXPECT_EQ(types[0].flops, 13000);
+  EXPECT_EQ(types[0].weightBytes, 5120u);
+  EXPECT_EQ(types[0].blobBytes, 3072u);
+  EXPECT_EQ(types[1].type, "BatchNorm");
+
+  std::string text = profiler.textReport(1);
+  EXPECT_NE(text.find("input 1x3x416x416: 9.50 ms/frame"), std::string::npos)
+      << text;
+  EXPECT_NE(text.find("conv_1"), std::string::npos);
+  EXPECT_EQ(text.find("conv_0 "), std::string::npos)
+      << "Only the slowest layer is listed";
+
+  std::string json = profiler.jsonReport();
+  EXPECT_EQ(json.rfind("{\"frames\":2,\"inputShape\":[1,3,416,416]", 0), 0u)
+      << json;
+  EXPECT_NE(json.find(R"({"id":3,"name":"conv_1","type":"Convolution",)"
+                      R"("msPerFrame":6,"share":0.631579,"flops":9000,)"),
+            std::string::npos)
+      << json;
+  EXPECT_LT(json.find(R"({"type":"Convolution")"),
+            json.find(R"({"type":"BatchNorm")"));
+}
+
+/**
+ * @test CollectsFromANetwork
+ * @brief Checks that the profiler reads per-layer timings and costs from a
+ * real network for the requested number of frames.
+ */
+TEST(LayerProfilerTest, CollectsFromANetwork) {
+  // A 3x3 convolution followed by a ReLU
+  cv::dnn::Net net;
+  cv::dnn::LayerParams conv;
+  conv.name = "conv";
+  conv.type = "Convolution";
+  conv.set("kernel_size", 3);
+  conv.set("pad", 1);
+  conv.set("num_output", 4);
+  conv.set("bias_term", false);
+  const int weightShape[] = {4, 3, 3, 3};
+  conv.blobs.push_back(cv::Mat(4, weightShape, CV_32F, cv::Scalar(0.1)));
+  net.addLayerToPrev(conv.name, conv.type, conv);
+  cv::dnn::LayerParams relu;
+  relu.name = "relu";
+  relu.type = "ReLU";
+  net.addLayerToPrev(relu.name, relu.type, relu);
+  net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+
+  const int blobShape[] = {1, 3, 32, 32};
+  cv::Mat blob(4, blobShape, CV_32F, cv::Scalar(1.0));
+  LayerProfiler profiler(2);
+  for (int pass = 0; pass < 3; ++pass) {
+    net.setInput(blob);
+    net.forward();
+    EXPECT_EQ(profiler.collect(net, blob), pass < 2)
+        << "Passes after the frame limit are not added";
+  }
+  EXPECT_EQ(profiler.frames(), 2u);
+  EXPECT_EQ(profiler.inputShape(), cv::dnn::MatShape({1, 3, 32, 32}));
+
+  // The timings line up with the layers of the network
+  std::vector<LayerCost> layers = profiler.byLayer();
+  ASSERT_EQ(layers.size(), 2u);
+  std::sort(layers.begin(), layers.end(),
+            [](const LayerCost& a, const LayerCost& b) { return a.id < b.id; });
+  EXPECT_EQ(layers[0].id, net.getLayerId("conv"));
+  EXPECT_EQ(layers[0].name, "conv");
+  EXPECT_EQ(layers[0].type, "Convolution");
+  EXPECT_GT(layers[0].flops, 0);
+  EXPECT_GT(layers[0].weightBytes, 0u);
+  EXPECT_EQ(layers[1].id, net.getLayerId("relu"));
+  EXPECT_EQ(layers[1].name, "relu");
+  EXPECT_EQ(layers[1].type, "ReLU");
+  EXPECT_GT(profiler.totalMs(), 0.0);
+}
+
+/**
+ * @test SharedTrackingImagesAndBoxMapping
+ * @brief Checks that the cache shares or reuses its tracking images across
+ * frames and maps boxes between frame and tracking coordinates.
+ */
+TEST(FrameCacheTest, SharedTrackingImagesAndBoxMapping) {
+  EXPECT_THROW(FrameCache({0.0}), std::invalid_argument);
+  EXPECT_THROW(FrameCache({1.5}), std::invalid_argument);
+
+  cv::Mat frame(720, 1280, CV_8UC3);
+  cv::RNG rng(41);
+  rng.fill(frame, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(255));
+
+  // Full-resolution colour tracking shares the frame as it is
+  FrameCache full;
+  full.update(frame);
+  EXPECT_EQ(full.trackingImage().data, frame.data);
+  EXPECT_TRUE(full.gray().empty());
+  EXPECT_EQ(full.toTracking(cv::Rect(10, 20, 30, 40)),
+            cv::Rect(10, 20, 30, 40));
+
+  FrameCache half({0.5, true});
+  half.update(frame);
+  EXPECT_EQ(half.scaled().size(), cv::Size(640, 360));
+  EXPECT_EQ(half.trackingImage().data, half.gray().data);
+  EXPECT_EQ(half.gray().channels(), 1);
+  const uchar* gray = half.gray().data;
+  half.update(frame);
+  EXPECT_EQ(half.gray().data, gray) << "Images are reused between frames";
+
+  const cv::Rect box(101, 50, 41, 81);
+  cv::Rect tracked = half.toTracking(box);
+  EXPECT_EQ(tracked, cv::Rect(51, 25, 21, 41));
+  cv::Rect back = half.toFrame(tracked);
+  EXPECT_LE(std::abs(back.x - box.x), 1);
+  EXPECT_LE(std::abs(back.br().y - box.br().y), 1);
+  EXPECT_EQ(half.toTracking(cv::Rect(0, 0, 1, 1)).area(), 1)
+      << "Tiny boxes keep a pixel";
+
+  // Trackers run on the half-size grayscale image; boxes stay in the frame
+  Tracker tracker("", "", "", cv::Mat());
+  tracker.setDrawOverlays(false);
+  tracker.setFrameCache({0.5, true});
+  const std::vector<cv::Rect> people = {cv::Rect(200, 100, 80, 200),
+                                        cv::Rect(800, 300, 60, 150)};
+  tracker.updateTrackers(people, frame);
+  EXPECT_EQ(tracker.activeTrackCount(), 2u);
+  EXPECT_EQ(tracker.getFrameCache().trackingImage().size(),
+            cv::Size(640, 360));
+  tracker.updateTrackers({}, frame);
+  ASSERT_EQ(tracker.activeTrackCount(), 2u);
+  for (const auto& slot : tracker.getTrackSlots()) {
+    if (!slot.active) {
+      continue;
+    }
+    const cv::Rect& person = people[slot.id];
+    EXPECT_LE(std::abs(slot.box.x - person.x), 4) << slot.box;
+    EXPECT_LE(std::abs(slot.box.y - person.y), 4) << slot.box;
+    EXPECT_LE(std::abs(slot.box.width - person.width), 4) << slot.box;
+  }
+
+  tracker.setFrameCache({1.0});
+  EXPECT_EQ(tracker.activeTrackCount(), 0u);
+}